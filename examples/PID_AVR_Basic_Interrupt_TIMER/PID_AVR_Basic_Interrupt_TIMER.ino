@@ -1,14 +1,15 @@
 /********************************************************
    PID AVR Basic Interrupt TIMER Example
    Reading analog input 0 to control analog PWM output 3
+   The PID is computed directly inside the timer interrupt.
  ********************************************************/
 #include "TimerOne.h" // https://github.com/PaulStoffregen/TimerOne
 #include "QuickPID.h"
+#include "QuickPIDIsr.h"
 
 #define PIN_INPUT 0
 #define PIN_OUTPUT 3
 const uint32_t sampleTimeUs = 100000; // 100ms
-volatile bool computeNow = false;
 
 //Define Variables we'll be connecting to
 float Setpoint, Input, Output;
@@ -17,31 +18,29 @@ float Kp = 2, Ki = 5, Kd = 1;
 
 //specify the links
 QuickPID myPID(&Input, &Output, &Setpoint);
+QuickPIDIsr isrPID(myPID);
 
 void setup() {
-  Timer1.initialize(sampleTimeUs); //initialize timer1, and set the time interval
-  Timer1.attachInterrupt(runPid);  //attaches runPid() as a timer overflow interrupt
-
   //initialize the variables we're linked to
   Input = analogRead(PIN_INPUT);
-  Setpoint = 100;
 
-  //apply PID gains
-  myPID.SetTunings(Kp, Ki, Kd);
+  //apply the setpoint and PID gains, the interrupt picks them up without tearing
+  myPID.SetSampleTimeUs(sampleTimeUs);
+  isrPID.SetSetpoint(100);
+  isrPID.SetTunings(Kp, Ki, Kd);
 
   //turn the PID on
-  myPID.SetMode(myPID.Control::automatic);
+  myPID.SetMode(myPID.Control::timer);
+
+  Timer1.initialize(sampleTimeUs); //initialize timer1, and set the time interval
+  Timer1.attachInterrupt(runPid);  //attaches runPid() as a timer overflow interrupt
 }
 
 void loop() {
-  if (computeNow) {
-    Input = analogRead(PIN_INPUT);
-    myPID.Compute();
-    analogWrite(PIN_OUTPUT, Output);
-    computeNow = false;
-  }
 }
 
 void runPid() {
-  computeNow = true;
+  Input = analogRead(PIN_INPUT);
+  isrPID.Compute();
+  analogWrite(PIN_OUTPUT, Output);
 }
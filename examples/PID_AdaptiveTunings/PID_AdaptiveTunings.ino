@@ -5,9 +5,12 @@
    be agressive at some times and conservative at others. In the example below,
    we set the controller to use conservative tuning parameters when we're near
    setpoint and more agressive tuning parameters when we're farther away.
+   A gain schedule holds both sets pre-scaled, so switching between them is
+   a constant time table lookup and is bumpless.
  ******************************************************************************/
 
 #include "QuickPID.h"
+#include "QuickPIDGainSchedule.h"
 
 #define PIN_INPUT 0
 #define PIN_OUTPUT 3
@@ -22,12 +25,20 @@ float consKp = 1, consKi = 0.05, consKd = 0.25;
 //Specify the links
 QuickPID myPID(&Input, &Output, &Setpoint);
 
+//Two gain sets keyed on the distance from setpoint, with breakpoints at 0 and 10
+QuickPIDGains gainTable[2];
+QuickPIDGainSchedule schedule(myPID, gainTable, 2, 0, 10);
+
 void setup()
 {
   //initialize the variables we're linked to
   Input = analogRead(PIN_INPUT);
   Setpoint = 100;
 
+  //pre-scale the gain sets
+  schedule.SetTunings(0, consKp, consKi, consKd); //we're close to setpoint, use conservative tuning parameters
+  schedule.SetTunings(1, aggKp, aggKi, aggKd);    //we're far from setpoint, use aggressive tuning parameters
+
   //turn the PID on
   myPID.SetMode(myPID.Control::automatic);
 }
@@ -37,12 +48,7 @@ void loop()
   Input = analogRead(PIN_INPUT);
 
   float gap = abs(Setpoint - Input); //distance away from setpoint
-  if (gap < 10) { //we're close to setpoint, use conservative tuning parameters
-    myPID.SetTunings(consKp, consKi, consKd);
-  } else {
-    //we're far from setpoint, use aggressive tuning parameters
-    myPID.SetTunings(aggKp, aggKi, aggKd);
-  }
+  schedule.Update(gap);
   myPID.Compute();
   analogWrite(PIN_OUTPUT, Output);
 }
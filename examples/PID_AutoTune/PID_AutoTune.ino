@@ -0,0 +1,103 @@
+/********************************************************
+   PID AutoTune Example
+   Reading analog input 0 to control analog PWM output 3
+   A relay test finds the ultimate gain and period, then
+   the PID takes over with the computed tunings.
+
+   The same file is a host side check: built as plain C++
+   (g++ -x c++), it runs the relay test against simulated
+   direct and reverse acting processes, which must give
+   the same Ku and Pu. The exit status is 1 when not.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "QuickPIDAutoTune.h"
+
+#if defined(ARDUINO)
+
+#define PIN_INPUT 0
+#define PIN_OUTPUT 3
+
+const uint32_t sampleTimeUs = 100000; // 100ms
+uint32_t lastSample;
+
+//Define Variables we'll be connecting to
+float Setpoint = 100, Input, Output;
+
+//Specify the links
+QuickPID myPID(&Input, &Output, &Setpoint);
+QuickPIDAutoTune tuner(&Input, &Output, &Setpoint);
+
+void setup()
+{
+  Serial.begin(115200);
+  myPID.SetSampleTimeUs(sampleTimeUs);
+
+  //relay output 127 +/- 100, 2 counts of hysteresis, average 4 cycles
+  tuner.Configure(127, 100, 2, 4, sampleTimeUs);
+  tuner.Start();
+  lastSample = micros();
+}
+
+void loop()
+{
+  Input = analogRead(PIN_INPUT);
+  if (tuner.GetStatus() == QuickPIDAutoTune::Status::running) {
+    if (micros() - lastSample >= sampleTimeUs) {
+      lastSample += sampleTimeUs;
+      if (tuner.Run() == QuickPIDAutoTune::Status::done) {
+        tuner.SetTunings(myPID, QuickPIDAutoTune::Rule::zieglerNicholsPID);
+        Serial.print(F("Ku: "));  Serial.print(tuner.GetKu());
+        Serial.print(F(" Pu: ")); Serial.print(tuner.GetPu());
+        Serial.print(F(" Kp: ")); Serial.print(myPID.GetKp());
+        Serial.print(F(" Ki: ")); Serial.print(myPID.GetKi());
+        Serial.print(F(" Kd: ")); Serial.println(myPID.GetKd());
+        myPID.SetMode(myPID.Control::automatic);
+      }
+    }
+  } else {
+    myPID.Compute();
+  }
+  analogWrite(PIN_OUTPUT, Output);
+}
+
+#else // host side check
+
+#include "QuickPIDPlant.h"
+#include <math.h>
+#include <stdio.h>
+
+const float sampleTimeSec = 0.1f;
+
+float Setpoint, Input, Output;
+QuickPIDAutoTune tuner(&Input, &Output, &Setpoint);
+float deadTime[10];
+QuickPIDPlant plant(deadTime, 10);
+
+//Relay test of a process with gain Gain, 5 s lag and 1 s dead time, starting at rest at the setpoint
+bool relayTest(float Gain, QuickPID::Action Action, float &Ku, float &Pu)
+{
+  plant.SetModel(QuickPIDPlant::Model::fopdt, Gain, 5.0f, 0, 1.0f, sampleTimeSec);
+  Setpoint = Gain * 127;
+  Input = Setpoint;
+  plant.Reset(Input, 127);
+  tuner.Configure(127, 20, 0.5f, 4, sampleTimeSec * 1000000, Action);
+  tuner.Start();
+  while (tuner.Run() == QuickPIDAutoTune::Status::running) Input = plant.Step(Output);
+  Ku = tuner.GetKu();
+  Pu = tuner.GetPu();
+  printf("%s Ku %.2f Pu %.2f\n", (Action == QuickPID::Action::direct) ? "direct " : "reverse", Ku, Pu);
+  return tuner.GetStatus() == QuickPIDAutoTune::Status::done;
+}
+
+int main()
+{
+  float ku, pu, kuReverse, puReverse;
+  bool done = relayTest(2, QuickPID::Action::direct, ku, pu);
+  done = relayTest(-2, QuickPID::Action::reverse, kuReverse, puReverse) && done;
+  bool ok = done && fabsf(kuReverse - ku) <= 0.05f * ku && fabsf(puReverse - pu) <= 0.05f * pu;
+  printf(ok ? "PASS\n" : "FAIL\n");
+  return ok ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,233 @@
+/********************************************************
+   PID Benchmark Example
+   Times Compute() for every combination of controller
+   action, proportional, derivative and anti-windup mode,
+   and one BasicQuickPID and QuickPIDLite configuration,
+   and prints the RAM used per controller instance.
+
+   Cortex-M3/M4/M7 and x86 hosts count CPU cycles, other
+   Arduino targets use micros() and F_CPU. The sketch also
+   builds as plain C++ on a host (g++ -x c++), where it
+   prints to stdout, in nanoseconds on hosts other than x86.
+
+   Flash per configuration: build with -DBENCH_FOOTPRINT=1
+   (reference, no PID), 2 (QuickPID) or 3 (BasicQuickPID
+   with the BENCH_ modes below) and subtract the reported
+   program and data sizes of build 1 from builds 2 and 3.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "BasicQuickPID.h"
+#include "QuickPIDLite.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+#include <chrono>
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) || \
+    ((defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)))
+#define BENCH_CYCLES  // QuickPIDClock::cycleCount() is available
+#endif
+
+#ifndef BENCH_ACTION
+#define BENCH_ACTION direct
+#endif
+#ifndef BENCH_PMODE
+#define BENCH_PMODE pOnError
+#endif
+#ifndef BENCH_DMODE
+#define BENCH_DMODE dOnMeas
+#endif
+#ifndef BENCH_IAWMODE
+#define BENCH_IAWMODE iAwCondition
+#endif
+
+const uint16_t calls = 1000;  // Compute() calls per measurement
+
+//Define Variables we'll be connecting to
+float Setpoint = 100, Input, Output;
+
+//varying input so each call does the full calculation
+const float inputs[8] = {90, 95, 98, 101, 104, 102, 99, 97};
+
+#if !defined(BENCH_FOOTPRINT)
+
+QuickPID myPID(&Input, &Output, &Setpoint, 2, 5, 1,
+               QuickPID::pMode::pOnError, QuickPID::dMode::dOnMeas,
+               QuickPID::iAwMode::iAwCondition, QuickPID::Action::direct);
+
+typedef BasicQuickPID<QuickPID::Action::BENCH_ACTION, QuickPID::pMode::BENCH_PMODE,
+                      QuickPID::dMode::BENCH_DMODE, QuickPID::iAwMode::BENCH_IAWMODE> BenchBasicPID;
+BenchBasicPID myBasicPID(&Input, &Output, &Setpoint, 2, 5, 1);
+
+typedef QuickPIDLite<QuickPID::Action::BENCH_ACTION, QuickPID::pMode::BENCH_PMODE,
+                     QuickPID::dMode::BENCH_DMODE, QuickPID::iAwMode::BENCH_IAWMODE> BenchLitePID;
+BenchLitePID myLitePID(2, 5, 1);
+
+const char *const actionName[] = {"direct ", "reverse"};
+const char *const pModeName[] = {"pOnError    ", "pOnMeas     ", "pOnErrorMeas"};
+const char *const dModeName[] = {"dOnError", "dOnMeas "};
+const char *const iAwModeName[] = {"iAwCondition", "iAwClamp    ", "iAwOff      ", "iAwBackCalc "};
+
+void print(const char *s) {
+#if defined(ARDUINO)
+  Serial.print(s);
+#else
+  fputs(s, stdout);
+#endif
+}
+
+void print(uint32_t n) {
+#if defined(ARDUINO)
+  Serial.print(n);
+#else
+  printf("%lu", (unsigned long)n);
+#endif
+}
+
+// Elapsed time units: CPU cycles, or microseconds / nanoseconds without a cycle counter.
+uint32_t benchTicks() {
+#if defined(BENCH_CYCLES)
+  return QuickPIDClock::cycleCount();
+#elif defined(ARDUINO)
+  return micros();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Average time per call, in cycles where they can be derived, otherwise in nanoseconds.
+uint32_t perCall(uint32_t ticks) {
+#if defined(BENCH_CYCLES) || !defined(ARDUINO)
+  return ticks / calls;
+#elif defined(F_CPU)
+  return (uint32_t)((uint64_t)ticks * (F_CPU / 1000000UL) / calls);
+#else
+  return (uint32_t)((uint64_t)ticks * 1000 / calls);
+#endif
+}
+
+const char *unit() {
+#if defined(BENCH_CYCLES) || (defined(ARDUINO) && defined(F_CPU))
+  return " cycles\n";
+#else
+  return " ns\n";
+#endif
+}
+
+// Times Compute() in timer mode, so every call runs the calculation. Includes the loop overhead.
+template <class T>
+uint32_t measure(T &pid) {
+  pid.SetMode(QuickPID::Control::manual);
+  Input = inputs[0];
+  pid.SetMode(QuickPID::Control::timer);
+  uint32_t t0 = benchTicks();
+  for (uint16_t i = 0; i < calls; i++) {
+    Input = inputs[i & 7];
+    pid.Compute();
+  }
+  return perCall(benchTicks() - t0);
+}
+
+// Same for QuickPIDLite, which takes and returns values.
+uint32_t measure(BenchLitePID &pid) {
+  pid.Initialize(inputs[0], Output);
+  uint32_t t0 = benchTicks();
+  for (uint16_t i = 0; i < calls; i++) {
+    Output = pid.Compute(inputs[i & 7], Setpoint);
+  }
+  return perCall(benchTicks() - t0);
+}
+
+void setup()
+{
+#if defined(ARDUINO)
+  Serial.begin(115200);
+  while (!Serial) {}
+#endif
+#if defined(BENCH_CYCLES) && defined(ARDUINO)
+  QuickPIDClock::EnableCycleCounter();
+#endif
+
+  print("RAM per instance: QuickPID "); print((uint32_t)sizeof(QuickPID));
+  print(" bytes, BasicQuickPID "); print((uint32_t)sizeof(BenchBasicPID));
+  print(" bytes, QuickPIDLite "); print((uint32_t)sizeof(BenchLitePID)); print(" bytes\n\n");
+
+  print("Compute() per call\n");
+  for (uint8_t a = 0; a < 2; a++) {
+    for (uint8_t p = 0; p < 3; p++) {
+      for (uint8_t d = 0; d < 2; d++) {
+        for (uint8_t aw = 0; aw < 4; aw++) {
+          myPID.SetControllerDirection((QuickPID::Action)a);
+          myPID.SetProportionalMode((QuickPID::pMode)p);
+          myPID.SetDerivativeMode((QuickPID::dMode)d);
+          myPID.SetAntiWindupMode((QuickPID::iAwMode)aw);
+          uint32_t t = measure(myPID);
+          print(actionName[a]); print(" "); print(pModeName[p]); print(" ");
+          print(dModeName[d]); print(" "); print(iAwModeName[aw]); print("  ");
+          print(t); print(unit());
+        }
+      }
+    }
+  }
+
+  uint32_t t = measure(myBasicPID);
+  print("\nBasicQuickPID ");
+  print(actionName[(uint8_t)QuickPID::Action::BENCH_ACTION]); print(" ");
+  print(pModeName[(uint8_t)QuickPID::pMode::BENCH_PMODE]); print(" ");
+  print(dModeName[(uint8_t)QuickPID::dMode::BENCH_DMODE]); print(" ");
+  print(iAwModeName[(uint8_t)QuickPID::iAwMode::BENCH_IAWMODE]); print("  ");
+  print(t); print(unit());
+
+  t = measure(myLitePID);
+  print("QuickPIDLite  ");
+  print(actionName[(uint8_t)QuickPID::Action::BENCH_ACTION]); print(" ");
+  print(pModeName[(uint8_t)QuickPID::pMode::BENCH_PMODE]); print(" ");
+  print(dModeName[(uint8_t)QuickPID::dMode::BENCH_DMODE]); print(" ");
+  print(iAwModeName[(uint8_t)QuickPID::iAwMode::BENCH_IAWMODE]); print("  ");
+  print(t); print(unit());
+}
+
+#else // BENCH_FOOTPRINT
+
+#if BENCH_FOOTPRINT == 2
+QuickPID myPID(&Input, &Output, &Setpoint, 2, 5, 1,
+               QuickPID::pMode::BENCH_PMODE, QuickPID::dMode::BENCH_DMODE,
+               QuickPID::iAwMode::BENCH_IAWMODE, QuickPID::Action::BENCH_ACTION);
+#elif BENCH_FOOTPRINT == 3
+BasicQuickPID<QuickPID::Action::BENCH_ACTION, QuickPID::pMode::BENCH_PMODE,
+              QuickPID::dMode::BENCH_DMODE, QuickPID::iAwMode::BENCH_IAWMODE> myPID(&Input, &Output, &Setpoint, 2, 5, 1);
+#endif
+
+volatile uint8_t sample;
+
+void setup()
+{
+#if BENCH_FOOTPRINT > 1
+  myPID.SetMode(QuickPID::Control::timer);
+#endif
+}
+
+#endif // BENCH_FOOTPRINT
+
+void loop()
+{
+#if defined(BENCH_FOOTPRINT)
+  Input = inputs[sample & 7];
+#if BENCH_FOOTPRINT > 1
+  myPID.Compute();
+#endif
+  sample = (uint8_t)Output;
+#endif
+}
+
+#if !defined(ARDUINO)
+int main()
+{
+  setup();
+  loop();
+  return 0;
+}
+#endif
@@ -0,0 +1,96 @@
+/********************************************************
+   PID Binary Trace Example
+   Reading analog input 0 to control analog PWM output 3
+   Every calculation is traced and sent over Serial in
+   compact binary frames instead of text.
+
+   The same file is the host side decoder: built as plain
+   C++ (g++ -x c++), it reads the frames from stdin and
+   prints one line per sample, for example
+   ./PID_BinaryTrace < /dev/ttyUSB0
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "QuickPIDTrace.h"
+#include "QuickPIDTraceFormat.h"
+
+#if defined(ARDUINO)
+
+#define PIN_INPUT 0
+#define PIN_OUTPUT 3
+
+//Define Variables we'll be connecting to
+float Setpoint = 100, Input, Output;
+
+float Kp = 2, Ki = 5, Kd = 1;
+
+//Specify PID links, the extension holding the trace link, the trace buffer and the encoder (0.01 resolution)
+QuickPID myPID(&Input, &Output, &Setpoint);
+QuickPIDExtension pidExtension;
+QuickPIDSample traceBuffer[32];
+QuickPIDTrace trace(traceBuffer, 32);
+QuickPIDTraceEncoder encoder(100);
+
+QuickPIDSample batch[8];
+uint8_t frame[QUICKPID_TRACE_FRAME_MAX];
+uint32_t lastHeader;
+
+void setup()
+{
+  Serial.begin(115200);
+  Input = analogRead(PIN_INPUT);
+  myPID.SetTunings(Kp, Ki, Kd);
+  myPID.SetMode(myPID.Control::automatic);
+  myPID.SetExtension(&pidExtension);
+  myPID.SetTrace(&trace);
+  lastHeader = millis() - 5000;
+}
+
+void loop()
+{
+  Input = analogRead(PIN_INPUT);
+  myPID.Compute();
+  analogWrite(PIN_OUTPUT, Output);
+
+  //a header every 5 s, so a decoder can join at any time
+  if (millis() - lastHeader >= 5000) {
+    lastHeader += 5000;
+    Serial.write(frame, encoder.Header(frame, myPID));
+  }
+  //send the samples in batches, outside the calculation
+  if (trace.Available() >= 8) {
+    uint8_t n = trace.Read(batch, 8);
+    uint8_t used;
+    Serial.write(frame, encoder.Samples(frame, batch, n, used));
+  }
+}
+
+#else // host side decoder
+
+#include <stdio.h>
+
+QuickPIDTraceDecoder decoder;
+
+int main()
+{
+  int c;
+  while ((c = getchar()) != EOF) {
+    QuickPIDTraceDecoder::Frame f = decoder.Put((uint8_t)c);
+    if (f == QuickPIDTraceDecoder::Frame::header) {
+      const QuickPIDTraceHeader &h = decoder.GetHeader();
+      printf("# Kp %g Ki %g Kd %g mode %u direction %u pmode %u dmode %u awmode %u\n",
+             h.kp, h.ki, h.kd, h.mode, h.direction, h.pmode, h.dmode, h.awmode);
+      printf("# time input setpoint pTerm iTerm dTerm output\n");
+    } else if (f == QuickPIDTraceDecoder::Frame::samples) {
+      const QuickPIDSample *s = decoder.GetSamples();
+      for (uint8_t i = 0; i < decoder.GetCount(); i++) {
+        printf("%lu %g %g %g %g %g %g\n", (unsigned long)s[i].time, s[i].input, s[i].setpoint,
+               s[i].pTerm, s[i].iTerm, s[i].dTerm, s[i].output);
+      }
+    }
+  }
+  fprintf(stderr, "%lu bad frames\n", (unsigned long)decoder.GetErrors());
+  return 0;
+}
+
+#endif
@@ -14,7 +14,7 @@ float Setpoint = 0, Input = 0, Output = 0, Kp = 2, Ki = 5, Kd = 1;
 QuickPID myPID(&Input, &Output, &Setpoint, Kp, Ki, Kd,  /* OPTIONS */
                myPID.pMode::pOnError,                   /* pOnError, pOnMeas, pOnErrorMeas */
                myPID.dMode::dOnMeas,                    /* dOnError, dOnMeas */
-               myPID.iAwMode::iAwCondition,             /* iAwCondition, iAwClamp, iAwOff */
+               myPID.iAwMode::iAwCondition,             /* iAwCondition, iAwClamp, iAwOff, iAwBackCalc */
                myPID.Action::direct);                   /* direct, reverse */
 
 void setup()
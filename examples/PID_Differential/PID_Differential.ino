@@ -0,0 +1,536 @@
+/********************************************************
+   PID Differential Test Example
+   Runs random gains, output limits, sample times and
+   input and setpoint sequences through the reference
+   QuickPID::Compute() and through every other engine
+   (value-passing Compute(), ComputeBatch(), Compute(nowUs),
+   QuickPIDIsr, QuickPIDScheduler, QuickPIDCascade,
+   BasicQuickPID, QuickPIDLite, QuickPIDBank and
+   QuickPIDFixed) for all 48 combinations of controller
+   action, proportional, derivative and anti-windup mode.
+   Partway through each case the controller is switched
+   to manual, given a new output and switched back, so
+   the bumpless re-initialization is compared as well.
+
+   For each engine it prints the largest difference from
+   the reference in ppm of the output range, where it
+   happened, and the time per calculation. The float
+   engines must match the reference bit for bit, except
+   Compute(nowUs), which scales the gains by the measured
+   time step, and QuickPIDFixed, which must stay within
+   its Q16.16 resolution. A checksum
+   of all reference outputs shows whether two builds or
+   targets compute the same results.
+
+   The sketch also builds as plain C++ on a host, for
+   example g++ -O2 -x c++ PID_Differential.ino -x none
+   -I src src/QuickPID*.cpp, and runs as ./a.out [cases] [seed].
+   The exit status is 1 when an engine is out of its
+   tolerance.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "BasicQuickPID.h"
+#include "QuickPIDLite.h"
+#include "QuickPIDBank.h"
+#include "QuickPIDFixed.h"
+#include "QuickPIDIsr.h"
+#include "QuickPIDScheduler.h"
+#include "QuickPIDCascade.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#endif
+
+#if defined(__AVR__)
+#define STEPS 16     // calculations per case
+#define CASES 8      // cases per mode combination
+#else
+#define STEPS 200
+#define CASES 100
+#endif
+#define GROUP 4      // cases run together, one per QuickPIDBank channel
+
+// Largest allowed difference in ppm of the output range. With QUICKPID_DOUBLE_SUM or QUICKPID_KAHAN_SUM the
+// reference keeps a more precise integral sum than the other engines, which then only have to stay close.
+// QuickPIDFixed rounds the scaled integral gain to 1/65536, an error that the integral sum adds up over the
+// steps of a case. In its condition anti-windup a rounding difference can flip the decision to limit the integral,
+// and then the outputs part by a whole integral step, so it gets a looser bound. Compute(nowUs) scales the gains by
+// the time step in a different order than SetTunings(), which can differ in the last bit.
+#if defined(QUICKPID_DOUBLE_SUM) || defined(QUICKPID_KAHAN_SUM)
+const float floatTolerance = 100;
+#else
+const float floatTolerance = 0;
+#endif
+const float timeStepTolerance = 100;
+const float fixedTolerance = 5000;
+const float fixedConditionTolerance = 100000;
+
+struct DiffCase {
+  float kp, ki, kd;
+  float outMin, outMax, output;  // limits and initial output
+  float manualOutput;            // output set in manual mode at toggleStep
+  uint32_t sampleTimeUs;
+  float input[STEPS], setpoint[STEPS];
+};
+
+// Runs a group of cases through one engine with the modes of combination m and writes each case's outputs.
+typedef void (*tDiffEngine)(const DiffCase *c, uint8_t m, float out[][STEPS]);
+
+DiffCase cases[GROUP];
+uint16_t toggleStep;             // step of the group at which the controllers go to manual and back
+float reference[GROUP][STEPS], result[GROUP][STEPS];
+
+const char *const actionName[] = {"direct ", "reverse"};
+const char *const pModeName[] = {"pOnError    ", "pOnMeas     ", "pOnErrorMeas"};
+const char *const dModeName[] = {"dOnError", "dOnMeas "};
+const char *const iAwModeName[] = {"iAwCondition", "iAwClamp    ", "iAwOff      ", "iAwBackCalc "};
+
+// Mode combination m, in the order of the loops in PID_Benchmark.
+QuickPID::Action action(uint8_t m) { return static_cast<QuickPID::Action>(m / 24); }
+QuickPID::pMode pmode(uint8_t m) { return static_cast<QuickPID::pMode>(m / 8 % 3); }
+QuickPID::dMode dmode(uint8_t m) { return static_cast<QuickPID::dMode>(m / 4 % 2); }
+QuickPID::iAwMode iawmode(uint8_t m) { return static_cast<QuickPID::iAwMode>(m % 4); }
+
+void print(const char *s) {
+#if defined(ARDUINO)
+  Serial.print(s);
+#else
+  fputs(s, stdout);
+#endif
+}
+
+void print(uint32_t n) {
+#if defined(ARDUINO)
+  Serial.print(n);
+#else
+  printf("%lu", (unsigned long)n);
+#endif
+}
+
+void print(float f) {
+#if defined(ARDUINO)
+  Serial.print(f, 2);
+#else
+  printf("%.2f", f);
+#endif
+}
+
+uint32_t elapsedNs() {
+#if defined(ARDUINO)
+  return micros() * 1000;
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// xorshift32, so every target generates the same cases from the same seed.
+uint32_t seed = 1;
+
+uint32_t random32() {
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+float randomFloat(float Min, float Max) {
+  return Min + (Max - Min) * (float)(random32() >> 8) / 16777216.0f;
+}
+
+// Random settings, and an input that wanders with occasional jumps towards a setpoint with occasional steps.
+// The ranges keep QuickPIDFixed's terms within Q16.16.
+void makeCase(DiffCase &c) {
+  c.kp = randomFloat(0, 4);
+  c.ki = (random32() % 4 == 0) ? 0 : randomFloat(0, 8);
+  c.kd = (random32() % 4 == 0) ? 0 : randomFloat(0, 1);
+  c.sampleTimeUs = 10000 + random32() % 190000;
+  c.outMin = randomFloat(-100, 0);
+  c.outMax = c.outMin + randomFloat(20, 300);
+  c.output = randomFloat(c.outMin, c.outMax);
+  c.manualOutput = randomFloat(c.outMin - 10, c.outMax + 10);  // sometimes outside the limits
+  float in = randomFloat(0, 100), sp = randomFloat(0, 100);
+  for (uint16_t i = 0; i < STEPS; i++) {
+    in += randomFloat(-2, 2);
+    if (random32() % 20 == 0) in += randomFloat(-30, 30);
+    if (random32() % 32 == 0) sp = randomFloat(0, 100);
+    c.input[i] = in;
+    c.setpoint[i] = sp;
+  }
+}
+
+// Engines *********************************************************************************************************
+
+void configure(QuickPID &pid, const DiffCase &c, uint8_t m) {
+  pid.SetOutputLimits(c.outMin, c.outMax);
+  pid.SetSampleTimeUs(c.sampleTimeUs);
+  pid.SetControllerDirection(action(m));
+  pid.SetTunings(c.kp, c.ki, c.kd, pmode(m), dmode(m), iawmode(m));
+  pid.SetMode(QuickPID::Control::timer);
+}
+
+// At toggleStep the operator takes over with the step's input and setpoint, sets the manual output and hands back.
+template <class P, class T>
+void handBack(P &pid, T &input, T &output, T &setpoint, const DiffCase &c) {
+  input = T(c.input[toggleStep]);
+  setpoint = T(c.setpoint[toggleStep]);
+  pid.SetMode(QuickPID::Control::manual);
+  output = T(c.manualOutput);
+  pid.SetMode(QuickPID::Control::timer);
+}
+
+void runReference(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      input = c[g].input[i];
+      setpoint = c[g].setpoint[i];
+      pid.Compute();
+      out[g][i] = output;
+    }
+  }
+}
+
+void runValue(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      out[g][i] = pid.Compute(c[g].input[i], c[g].setpoint[i]);
+    }
+  }
+}
+
+void runBatch(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    pid.ComputeBatch(c[g].input, c[g].setpoint, out[g], toggleStep);
+    handBack(pid, input, output, setpoint, c[g]);
+    pid.ComputeBatch(c[g].input + toggleStep, c[g].setpoint + toggleStep, out[g] + toggleStep, STEPS - toggleStep);
+  }
+}
+
+// Timestamps one sample time apart, so each time step equals the sample time.
+void runTimeStep(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    uint32_t nowUs = 0;
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      input = c[g].input[i];
+      setpoint = c[g].setpoint[i];
+      pid.Compute(nowUs);
+      out[g][i] = output;
+      nowUs += c[g].sampleTimeUs;
+    }
+  }
+}
+
+void runIsr(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    QuickPIDIsr isr(pid);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      isr.SetSetpoint(c[g].setpoint[i]);
+      input = c[g].input[i];
+      isr.Compute();
+      out[g][i] = output;
+    }
+  }
+}
+
+// The group's controllers share one scheduler. Each due time sets the inputs of the controllers due then.
+void runScheduler(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  float input[GROUP], output[GROUP], setpoint[GROUP];
+  QuickPID pid[GROUP] = {  // one per case of the group
+    QuickPID(&input[0], &output[0], &setpoint[0]), QuickPID(&input[1], &output[1], &setpoint[1]),
+    QuickPID(&input[2], &output[2], &setpoint[2]), QuickPID(&input[3], &output[3], &setpoint[3])
+  };
+  QuickPIDScheduler<GROUP> scheduler(NULL);
+  uint16_t step[GROUP];
+  for (uint8_t g = 0; g < GROUP; g++) {
+    input[g] = c[g].input[0];
+    output[g] = c[g].output;
+    setpoint[g] = c[g].setpoint[0];
+    configure(pid[g], c[g], m);
+    scheduler.Add(pid[g]);
+    step[g] = 0;
+  }
+  for (;;) {
+    uint32_t nowUs = 0xFFFFFFFF;
+    for (uint8_t g = 0; g < GROUP; g++) {
+      uint32_t due = step[g] * c[g].sampleTimeUs;
+      if (step[g] < STEPS && due < nowUs) nowUs = due;
+    }
+    if (nowUs == 0xFFFFFFFF) break;
+    bool due[GROUP];
+    for (uint8_t g = 0; g < GROUP; g++) {
+      due[g] = (step[g] < STEPS && step[g] * c[g].sampleTimeUs == nowUs);
+      if (!due[g]) continue;
+      if (step[g] == toggleStep) handBack(pid[g], input[g], output[g], setpoint[g], c[g]);
+      input[g] = c[g].input[step[g]];
+      setpoint[g] = c[g].setpoint[step[g]];
+    }
+    scheduler.ComputeDue(nowUs);
+    for (uint8_t g = 0; g < GROUP; g++) {
+      if (due[g]) out[g][step[g]++] = output[g];
+    }
+  }
+}
+
+// A single stage cascade, run every tick.
+void runCascade(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    QuickPID pid(&input, &output, &setpoint);
+    configure(pid, c[g], m);
+    QuickPID *const stages[1] = {&pid};
+    const uint16_t dividers[1] = {1};
+    QuickPIDCascade<1> cascade(stages, dividers, c[g].sampleTimeUs);
+    cascade.Initialize(&input, output);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) {
+        handBack(pid, input, output, setpoint, c[g]);
+        cascade.Initialize(&input, output);
+      }
+      out[g][i] = cascade.Compute(c[g].setpoint[i], &c[g].input[i]);
+    }
+  }
+}
+
+template <QuickPID::Action A, QuickPID::pMode P, QuickPID::dMode D, QuickPID::iAwMode W>
+void runBasicModes(const DiffCase *c, uint8_t, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    float input = c[g].input[0], output = c[g].output, setpoint = c[g].setpoint[0];
+    BasicQuickPID<A, P, D, W> pid(&input, &output, &setpoint);
+    pid.SetOutputLimits(c[g].outMin, c[g].outMax);
+    pid.SetSampleTimeUs(c[g].sampleTimeUs);
+    pid.SetTunings(c[g].kp, c[g].ki, c[g].kd);
+    pid.SetMode(QuickPID::Control::timer);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      input = c[g].input[i];
+      setpoint = c[g].setpoint[i];
+      pid.Compute();
+      out[g][i] = output;
+    }
+  }
+}
+
+template <QuickPID::Action A, QuickPID::pMode P, QuickPID::dMode D, QuickPID::iAwMode W>
+void runLiteModes(const DiffCase *c, uint8_t, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    QuickPIDLite<A, P, D, W> pid;
+    pid.SetOutputLimits(c[g].outMin, c[g].outMax);
+    pid.SetSampleTimeUs(c[g].sampleTimeUs);
+    pid.SetTunings(c[g].kp, c[g].ki, c[g].kd);
+    pid.Initialize(c[g].input[0], c[g].output);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) pid.Initialize(c[g].input[i], c[g].manualOutput);
+      out[g][i] = pid.Compute(c[g].input[i], c[g].setpoint[i]);
+    }
+  }
+}
+
+// The template engines for all 48 mode combinations, in mode combination order.
+#define DIFF_W(F, A, P, D) \
+  &F<QuickPID::Action::A, QuickPID::pMode::P, QuickPID::dMode::D, QuickPID::iAwMode::iAwCondition>, \
+  &F<QuickPID::Action::A, QuickPID::pMode::P, QuickPID::dMode::D, QuickPID::iAwMode::iAwClamp>, \
+  &F<QuickPID::Action::A, QuickPID::pMode::P, QuickPID::dMode::D, QuickPID::iAwMode::iAwOff>, \
+  &F<QuickPID::Action::A, QuickPID::pMode::P, QuickPID::dMode::D, QuickPID::iAwMode::iAwBackCalc>
+#define DIFF_D(F, A, P) DIFF_W(F, A, P, dOnError), DIFF_W(F, A, P, dOnMeas)
+#define DIFF_P(F, A) DIFF_D(F, A, pOnError), DIFF_D(F, A, pOnMeas), DIFF_D(F, A, pOnErrorMeas)
+#define DIFF_ALL(F) DIFF_P(F, direct), DIFF_P(F, reverse)
+
+const tDiffEngine basicModes[48] = {DIFF_ALL(runBasicModes)};
+const tDiffEngine liteModes[48] = {DIFF_ALL(runLiteModes)};
+
+void runBasic(const DiffCase *c, uint8_t m, float out[][STEPS]) { basicModes[m](c, m, out); }
+void runLite(const DiffCase *c, uint8_t m, float out[][STEPS]) { liteModes[m](c, m, out); }
+
+void runBank(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  QuickPIDBank<GROUP> bank(pmode(m), dmode(m), iawmode(m), action(m));
+  for (uint8_t g = 0; g < GROUP; g++) {
+    bank.SetOutputLimits(g, c[g].outMin, c[g].outMax);
+    bank.SetSampleTimeUs(g, c[g].sampleTimeUs);
+    bank.SetTunings(g, c[g].kp, c[g].ki, c[g].kd);
+    bank.input[g] = c[g].input[0];
+    bank.output[g] = c[g].output;
+  }
+  bank.SetMode(QuickPID::Control::timer);
+  for (uint16_t i = 0; i < STEPS; i++) {
+    for (uint8_t g = 0; g < GROUP; g++) {
+      bank.input[g] = c[g].input[i];
+      bank.setpoint[g] = c[g].setpoint[i];
+    }
+    if (i == toggleStep) {
+      bank.SetMode(QuickPID::Control::manual);
+      for (uint8_t g = 0; g < GROUP; g++) bank.output[g] = c[g].manualOutput;
+      bank.SetMode(QuickPID::Control::timer);
+    }
+    bank.ComputeAll();
+    for (uint8_t g = 0; g < GROUP; g++) out[g][i] = bank.output[g];
+  }
+}
+
+void runFixed(const DiffCase *c, uint8_t m, float out[][STEPS]) {
+  for (uint8_t g = 0; g < GROUP; g++) {
+    qfix16 input = qfix16(c[g].input[0]), output = qfix16(c[g].output), setpoint = qfix16(c[g].setpoint[0]);
+    QuickPIDFixed pid(&input, &output, &setpoint);
+    pid.SetOutputLimits(qfix16(c[g].outMin), qfix16(c[g].outMax));
+    pid.SetSampleTimeUs(c[g].sampleTimeUs);
+    pid.SetControllerDirection(action(m));
+    pid.SetTunings(c[g].kp, c[g].ki, c[g].kd, pmode(m), dmode(m), iawmode(m));
+    pid.SetMode(QuickPID::Control::timer);
+    for (uint16_t i = 0; i < STEPS; i++) {
+      if (i == toggleStep) handBack(pid, input, output, setpoint, c[g]);
+      input = qfix16(c[g].input[i]);
+      setpoint = qfix16(c[g].setpoint[i]);
+      pid.Compute();
+      out[g][i] = output.toFloat();
+    }
+  }
+}
+
+// Harness *********************************************************************************************************
+
+struct DiffEngine {
+  const char *name;
+  tDiffEngine run;
+  float tolerance;            // ppm of the output range
+  float conditionTolerance;   // same, for iAwCondition
+  float worst;                // largest difference in ppm, in the other modes
+  float conditionWorst;       // and in iAwCondition
+  uint32_t worstCase;         // where it happened: case number, mode combination and step
+  uint8_t worstMode;
+  uint16_t worstStep;
+  uint32_t mismatches;        // outputs that differ at all
+  uint64_t ns;                // time spent, setup included
+};
+
+DiffEngine engines[] = {
+  {"Compute(Input, Setpoint)", runValue, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"ComputeBatch()          ", runBatch, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"Compute(nowUs)          ", runTimeStep, timeStepTolerance, timeStepTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDIsr             ", runIsr, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDScheduler       ", runScheduler, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDCascade         ", runCascade, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"BasicQuickPID           ", runBasic, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDLite            ", runLite, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDBank            ", runBank, floatTolerance, floatTolerance, 0, 0, 0, 0, 0, 0, 0},
+  {"QuickPIDFixed           ", runFixed, fixedTolerance, fixedConditionTolerance, 0, 0, 0, 0, 0, 0, 0},
+};
+const uint8_t engineCount = sizeof(engines) / sizeof(engines[0]);
+
+// Compares each engine with the reference over Cases random cases per mode combination, starting from Seed.
+// Prints the results and returns true when every engine is within its tolerance.
+bool runDifferential(uint32_t Cases, uint32_t Seed) {
+  seed = (Seed != 0) ? Seed : 1;
+  uint32_t groups = (Cases + GROUP - 1) / GROUP;
+  uint32_t checksum = 2166136261u;
+  uint64_t referenceNs = 0;
+  for (uint32_t n = 0; n < groups; n++) {
+    for (uint8_t g = 0; g < GROUP; g++) makeCase(cases[g]);
+    toggleStep = 1 + random32() % (STEPS - 1);
+    for (uint8_t m = 0; m < 48; m++) {
+      uint32_t t0 = elapsedNs();
+      runReference(cases, m, reference);
+      referenceNs += elapsedNs() - t0;
+      for (uint8_t g = 0; g < GROUP; g++) {
+        for (uint16_t i = 0; i < STEPS; i++) {
+          uint32_t bits;
+          memcpy(&bits, &reference[g][i], sizeof(bits));
+          checksum = (checksum ^ bits) * 16777619u;  // FNV-1a over the output bits
+        }
+      }
+      for (uint8_t e = 0; e < engineCount; e++) {
+        DiffEngine &d = engines[e];
+        t0 = elapsedNs();
+        d.run(cases, m, result);
+        d.ns += elapsedNs() - t0;
+        for (uint8_t g = 0; g < GROUP; g++) {
+          float scale = 1000000 / (cases[g].outMax - cases[g].outMin);
+          for (uint16_t i = 0; i < STEPS; i++) {
+            if (result[g][i] == reference[g][i]) continue;
+            float diff = (result[g][i] - reference[g][i]) * scale;
+            if (diff < 0) diff = -diff;
+            d.mismatches++;
+            if (d.conditionTolerance != d.tolerance && iawmode(m) == QuickPID::iAwMode::iAwCondition) {
+              if (!(diff <= d.conditionWorst)) d.conditionWorst = diff;  // NaN counts as worst
+            } else if (!(diff <= d.worst)) {
+              d.worst = diff;
+              d.worstCase = n * GROUP + g;
+              d.worstMode = m;
+              d.worstStep = i;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  uint32_t calculations = groups * GROUP * 48 * STEPS;
+  bool pass = true;
+  print("Reference Compute()       "); print((float)referenceNs / calculations);
+  print(" ns per calculation, checksum "); print(checksum); print("\n\n");
+  for (uint8_t e = 0; e < engineCount; e++) {
+    DiffEngine &d = engines[e];
+    bool ok = (d.worst <= d.tolerance && d.conditionWorst <= d.conditionTolerance);
+    pass = pass && ok;
+    print(d.name); print(ok ? "  ok  " : "  FAIL"); print("  max "); print(d.worst);
+    print(" ppm (tolerance "); print(d.tolerance); print("), "); print(d.mismatches);
+    print(" outputs differ, "); print((float)d.ns / calculations); print(" ns per calculation\n");
+    if (d.conditionTolerance != d.tolerance) {
+      print("  iAwCondition max "); print(d.conditionWorst); print(" ppm (tolerance ");
+      print(d.conditionTolerance); print(")\n");
+    }
+    if (d.worst > 0) {
+      print("  worst: case "); print(d.worstCase); print(" step "); print((uint32_t)d.worstStep); print(" ");
+      print(actionName[(uint8_t)action(d.worstMode)]); print(" "); print(pModeName[(uint8_t)pmode(d.worstMode)]);
+      print(" "); print(dModeName[(uint8_t)dmode(d.worstMode)]); print(" ");
+      print(iAwModeName[(uint8_t)iawmode(d.worstMode)]); print("\n");
+    }
+  }
+  print(pass ? "\nPASS " : "\nFAIL "); print(calculations); print(" calculations per engine\n");
+  return pass;
+}
+
+#if defined(ARDUINO)
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial) {}
+  runDifferential(CASES, 1);
+}
+
+void loop()
+{
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+  uint32_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : CASES;
+  uint32_t s = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1;
+  return runDifferential(n, s) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/********************************************************
+   PID Dual Core Example (ESP32, or RP2040 with FreeRTOS)
+   Reading analog inputs 34 and 35 to control PWM outputs
+   25 and 26. Both loops run every millisecond in a high
+   priority task on core 1, while loop() on the other
+   core changes the setpoints and prints the status.
+   The two sides only exchange data through lock-free
+   mailboxes, so WiFi or Serial can't delay the loops.
+   On RP2040 (Arduino-Pico), include FreeRTOS.h first.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "QuickPIDTask.h"
+
+#define PIN_INPUT_A 34
+#define PIN_INPUT_B 35
+#define PIN_OUTPUT_A 25
+#define PIN_OUTPUT_B 26
+
+//Links are unused, the task passes the values
+float Input, Output, Setpoint;
+
+QuickPID pidA(&Input, &Output, &Setpoint, 2, 5, 1, QuickPID::Action::direct);
+QuickPID pidB(&Input, &Output, &Setpoint, 1, 2, 0, QuickPID::Action::direct);
+QuickPID *loops[2] = {&pidA, &pidB};
+
+void readSensors(void *arg);
+void writeActuators(void *arg);
+
+//1 ms period, sensors read before and outputs written after the calculations
+QuickPIDTask<2> control(loops, 1000, readSensors, writeActuators);
+
+//control core
+void readSensors(void *arg) {
+  control.input[0] = analogRead(PIN_INPUT_A);
+  control.input[1] = analogRead(PIN_INPUT_B);
+}
+
+void writeActuators(void *arg) {
+  analogWrite(PIN_OUTPUT_A, control.output[0]);
+  analogWrite(PIN_OUTPUT_B, control.output[1]);
+}
+
+//application core
+void setup()
+{
+  Serial.begin(115200);
+  pidA.SetMode(QuickPID::Control::timer);
+  pidB.SetMode(QuickPID::Control::timer);
+  control.SetSetpoint(0, 100);
+  control.SetSetpoint(1, 200);
+  control.Start(1, configMAX_PRIORITIES - 1);  // core 1, highest priority
+}
+
+void loop()
+{
+  QuickPIDStatus s;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (control.GetStatus(i, s)) {
+      Serial.print(i); Serial.print(F(" "));
+      Serial.print(s.setpoint); Serial.print(F(" "));
+      Serial.print(s.input); Serial.print(F(" "));
+      Serial.println(s.output);
+    }
+  }
+  Serial.print(F("overruns ")); Serial.println(control.GetOverruns());
+  delay(500);
+}
@@ -0,0 +1,70 @@
+/********************************************************
+   PID Plant Simulation Example
+   The PID controls a simulated first order plus dead time
+   process instead of hardware, and prints the response to
+   a setpoint step. Runs as fast as possible, so a long
+   test takes a moment.
+
+   The sketch also builds as plain C++ on a host
+   (g++ -x c++), where it prints to stdout.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "QuickPIDPlant.h"
+
+#if !defined(ARDUINO)
+#include <stdio.h>
+#endif
+
+const float sampleTimeSec = 0.1f;
+const uint16_t samples = 600;   // 60 s simulated
+
+//Define Variables we'll be connecting to
+float Setpoint = 0, Input = 0, Output = 0;
+
+//Specify PID links and the plant, gain 2, 5 s lag, 1 s dead time
+QuickPID myPID(&Input, &Output, &Setpoint, 1.0f, 0.25f, 0.5f,
+               QuickPID::pMode::pOnError, QuickPID::dMode::dOnMeas,
+               QuickPID::iAwMode::iAwCondition, QuickPID::Action::direct);
+float deadTime[10];
+QuickPIDPlant plant(deadTime, 10);
+
+void print(uint16_t i, float sp, float pv, float out) {
+#if defined(ARDUINO)
+  Serial.print(i * sampleTimeSec); Serial.print(F(" "));
+  Serial.print(sp); Serial.print(F(" "));
+  Serial.print(pv); Serial.print(F(" "));
+  Serial.println(out);
+#else
+  printf("%.1f %.2f %.2f %.2f\n", i * sampleTimeSec, sp, pv, out);
+#endif
+}
+
+void setup()
+{
+#if defined(ARDUINO)
+  Serial.begin(115200);
+#endif
+  plant.SetModel(QuickPIDPlant::Model::fopdt, 2.0f, 5.0f, 0, 1.0f, sampleTimeSec);
+  myPID.SetSampleTimeUs(sampleTimeSec * 1000000);
+  myPID.SetMode(QuickPID::Control::timer);  // one Compute() per simulated sample
+
+  for (uint16_t i = 0; i < samples; i++) {
+    if (i == 10) Setpoint = 100;
+    myPID.Compute();
+    Input = plant.Step(Output);
+    if (i % 10 == 0) print(i, Setpoint, Input, Output);
+  }
+}
+
+void loop()
+{
+}
+
+#if !defined(ARDUINO)
+int main()
+{
+  setup();
+  return 0;
+}
+#endif
@@ -0,0 +1,164 @@
+/********************************************************
+   PID Replay Example
+   Reading analog input 0 to control analog PWM output 3
+   The last 100 inputs and setpoints are kept, and every
+   10 seconds a second controller with other tunings is
+   replayed over them with ComputeBatch() to show the
+   outputs it would have commanded.
+
+   The same file is a host side replay tool: built as
+   plain C++ (g++ -x c++), it maps a PID_BinaryTrace
+   capture file, replays its inputs and setpoints with
+   the recorded tunings (or new ones) and prints the
+   recorded and replayed outputs, for example
+   ./PID_Replay capture.bin 100000 2 5 1
+ ********************************************************/
+
+#include "QuickPID.h"
+
+#if defined(ARDUINO)
+
+#define PIN_INPUT 0
+#define PIN_OUTPUT 3
+#define SAMPLES 100
+
+//Define Variables we'll be connecting to
+float Setpoint = 100, Input, Output;
+
+//Specify the links and initial tuning parameters
+QuickPID myPID(&Input, &Output, &Setpoint, 2, 5, 1, myPID.Action::direct);
+//The candidate only reads the links in SetMode(), ComputeBatch() doesn't use them
+QuickPID candidate(&Input, &Output, &Setpoint, 1, 3, 0.5, candidate.Action::direct);
+
+float inputs[SAMPLES], setpoints[SAMPLES], outputs[SAMPLES], replayed[SAMPLES];
+uint8_t count;
+uint32_t lastReplay;
+
+void setup()
+{
+  Serial.begin(115200);
+  Input = analogRead(PIN_INPUT);
+  myPID.SetMode(myPID.Control::automatic);
+  candidate.SetMode(candidate.Control::timer);
+  lastReplay = millis();
+}
+
+void loop()
+{
+  Input = analogRead(PIN_INPUT);
+  if (myPID.Compute()) {
+    if (count == SAMPLES) {  //keep the last SAMPLES, oldest first
+      memmove(inputs, inputs + 1, (SAMPLES - 1) * sizeof(float));
+      memmove(setpoints, setpoints + 1, (SAMPLES - 1) * sizeof(float));
+      memmove(outputs, outputs + 1, (SAMPLES - 1) * sizeof(float));
+      count--;
+    }
+    inputs[count] = Input;
+    setpoints[count] = Setpoint;
+    outputs[count] = Output;
+    count++;
+  }
+  analogWrite(PIN_OUTPUT, Output);
+
+  if (millis() - lastReplay >= 10000 && count == SAMPLES) {
+    lastReplay += 10000;
+    candidate.Initialize(inputs[0], outputs[0], setpoints[0]);
+    uint32_t start = micros();
+    candidate.ComputeBatch(inputs, setpoints, replayed, SAMPLES);
+    uint32_t elapsed = micros() - start;
+    Serial.print(F("Replayed ")); Serial.print(SAMPLES);
+    Serial.print(F(" samples in ")); Serial.print(elapsed); Serial.println(F(" us"));
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+      Serial.print(inputs[i]); Serial.print(',');
+      Serial.print(outputs[i]); Serial.print(',');
+      Serial.println(replayed[i]);
+    }
+  }
+}
+
+#else // host side replay
+
+#include "QuickPIDTrace.h"
+#include "QuickPIDTraceFormat.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+  if (argc != 3 && argc != 6) {
+    fprintf(stderr, "usage: %s capture.bin SampleTimeUs [Kp Ki Kd]\n", argv[0]);
+    return 1;
+  }
+  int fd = open(argv[1], O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    fprintf(stderr, "can't read %s\n", argv[1]);
+    return 1;
+  }
+  //map the capture instead of reading it, so a long one isn't copied
+  const uint8_t *data = (const uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == (const uint8_t *)MAP_FAILED) {
+    fprintf(stderr, "can't map %s\n", argv[1]);
+    return 1;
+  }
+
+  //decode the first header and every sample into arrays
+  QuickPIDTraceDecoder decoder;
+  QuickPIDTraceHeader h = QuickPIDTraceHeader();
+  bool haveHeader = false;
+  std::vector<float> inputs, setpoints, outputs;
+  for (off_t i = 0; i < st.st_size; i++) {
+    QuickPIDTraceDecoder::Frame f = decoder.Put(data[i]);
+    if (f == QuickPIDTraceDecoder::Frame::header && !haveHeader) {
+      h = decoder.GetHeader();
+      haveHeader = true;
+    } else if (f == QuickPIDTraceDecoder::Frame::samples && haveHeader) {
+      const QuickPIDSample *s = decoder.GetSamples();
+      for (uint8_t j = 0; j < decoder.GetCount(); j++) {
+        inputs.push_back(s[j].input);
+        setpoints.push_back(s[j].setpoint);
+        outputs.push_back(s[j].output);
+      }
+    }
+  }
+  munmap((void *)data, st.st_size);
+  close(fd);
+  if (inputs.empty()) {
+    fprintf(stderr, "no samples after a header in %s\n", argv[1]);
+    return 1;
+  }
+
+  //the recorded controller, or the given tunings with the recorded modes
+  float Input = inputs[0], Output = outputs[0], Setpoint = setpoints[0];
+  QuickPID pid(&Input, &Output, &Setpoint);
+  float Kp = (argc == 6) ? atof(argv[3]) : h.kp;
+  float Ki = (argc == 6) ? atof(argv[4]) : h.ki;
+  float Kd = (argc == 6) ? atof(argv[5]) : h.kd;
+  pid.SetSampleTimeUs(strtoul(argv[2], NULL, 10));
+  pid.SetControllerDirection(static_cast<QuickPID::Action>(h.direction));
+  pid.SetTunings(Kp, Ki, Kd, static_cast<QuickPID::pMode>(h.pmode),
+                 static_cast<QuickPID::dMode>(h.dmode), static_cast<QuickPID::iAwMode>(h.awmode));
+  pid.SetMode(QuickPID::Control::timer);  //bumpless start from the first sample
+
+  size_t n = inputs.size();
+  std::vector<float> replayed(n);
+  pid.ComputeBatch(inputs.data(), setpoints.data(), replayed.data(), n);
+
+  double sum = 0;
+  printf("# Kp %g Ki %g Kd %g\n# input setpoint recorded replayed\n", Kp, Ki, Kd);
+  for (size_t i = 0; i < n; i++) {
+    printf("%g %g %g %g\n", inputs[i], setpoints[i], outputs[i], replayed[i]);
+    sum += (double)(replayed[i] - outputs[i]) * (replayed[i] - outputs[i]);
+  }
+  fprintf(stderr, "%lu samples, rms difference %g, %lu bad frames\n",
+          (unsigned long)n, sqrt(sum / n), (unsigned long)decoder.GetErrors());
+  return 0;
+}
+
+#endif
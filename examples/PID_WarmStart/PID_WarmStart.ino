@@ -0,0 +1,120 @@
+/********************************************************
+   PID Warm Start Example
+   Reading analog input 0 to control analog PWM output 3
+   The controller state is saved to EEPROM every minute,
+   spread over 8 records. After a reset, the controller
+   resumes from the newest record instead of re-settling.
+
+   The same file is a host side check: built as plain C++
+   (g++ -x c++), it saves a running controller to a store
+   in RAM, restores it into a new one as after a reset,
+   and checks that the restored controller's outputs are
+   the same as the running one's. The exit status is 1
+   when not.
+ ********************************************************/
+
+#include "QuickPID.h"
+#include "QuickPIDStore.h"
+
+#if defined(ARDUINO)
+
+#include <EEPROM.h>
+
+#define PIN_INPUT 0
+#define PIN_OUTPUT 3
+
+//Define Variables we'll be connecting to
+float Setpoint = 100, Input, Output;
+
+float Kp = 2, Ki = 5, Kd = 1;
+
+//Specify PID links
+QuickPID myPID(&Input, &Output, &Setpoint);
+
+//EEPROM access for the store, EEPROM.update() only writes changed bytes
+bool eeRead(uint32_t a, void *d, uint16_t n) {
+  uint8_t *p = (uint8_t *)d;
+  while (n--) *p++ = EEPROM.read(a++);
+  return true;
+}
+
+bool eeWrite(uint32_t a, const void *d, uint16_t n) {
+  const uint8_t *p = (const uint8_t *)d;
+  while (n--) EEPROM.update(a++, *p++);
+  return true;
+}
+
+QuickPIDStore store(eeRead, eeWrite, 0, 8);  // 8 records from address 0
+
+void setup()
+{
+  Input = analogRead(PIN_INPUT);
+  myPID.SetTunings(Kp, Ki, Kd);
+
+  //warm start from the last saved state, if there is one
+  store.Restore(myPID);
+
+  //turn the PID on
+  myPID.SetMode(myPID.Control::automatic);
+}
+
+void loop()
+{
+  Input = analogRead(PIN_INPUT);
+  myPID.Compute();
+  analogWrite(PIN_OUTPUT, Output);
+  store.Update(myPID, millis(), 60000);
+}
+
+#else // host side check
+
+#include <stdio.h>
+#include <string.h>
+
+uint8_t memory[256];  // stands in for the EEPROM
+
+bool ramRead(uint32_t a, void *d, uint16_t n) {
+  memcpy(d, memory + a, n);
+  return true;
+}
+
+bool ramWrite(uint32_t a, const void *d, uint16_t n) {
+  memcpy(memory + a, d, n);
+  return true;
+}
+
+int main()
+{
+  QuickPIDStore store(ramRead, ramWrite, 0, 2);
+  if (2 * QuickPIDStore::GetRecordSize() > sizeof(memory)) return 1;
+
+  //a running controller with a derivative on error, which kicks if the last error isn't restored
+  float Setpoint = 100, Input = 50, Output = 0;
+  QuickPID running(&Input, &Output, &Setpoint, 1, 0.5f, 1, QuickPID::pMode::pOnError,
+                   QuickPID::dMode::dOnError, QuickPID::iAwMode::iAwCondition, QuickPID::Action::direct);
+  running.SetMode(QuickPID::Control::timer);
+  for (uint8_t i = 0; i < 20; i++) {
+    Input = 50 + i;
+    running.Compute();
+  }
+  store.Save(running);
+
+  //after a "reset": a new controller, restored as in setup(), then turned on
+  float Input2 = Input, Output2 = 0;
+  QuickPID restored(&Input2, &Output2, &Setpoint);
+  store.Restore(restored);
+  restored.SetMode(QuickPID::Control::timer);
+
+  bool ok = true;
+  for (uint8_t i = 20; i < 40; i++) {
+    Input = Input2 = 50 + i;
+    running.Compute();
+    restored.Compute();
+    printf("running %.4f restored %.4f\n", Output, Output2);
+    if (Output != Output2) ok = false;
+  }
+  printf(ok ? "PASS\n" : "FAIL\n");
+  return ok ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+#ifndef BasicQuickPID_h
+#define BasicQuickPID_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   BasicQuickPID is a compile-time specialized QuickPID. The controller action,
+   proportional, derivative and anti-windup modes are template parameters, so
+   Compute() is generated without mode tests or unused terms. Use QuickPID when
+   the modes need to change at runtime.
+
+   BasicQuickPID<QuickPID::Action::direct, QuickPID::pMode::pOnMeas> myPID(&Input, &Output, &Setpoint);
+ **********************************************************************************/
+template <QuickPID::Action TAction = QuickPID::Action::direct,
+          QuickPID::pMode TpMode = QuickPID::pMode::pOnError,
+          QuickPID::dMode TdMode = QuickPID::dMode::dOnMeas,
+          QuickPID::iAwMode TiAwMode = QuickPID::iAwMode::iAwCondition>
+class BasicQuickPID {
+
+  public:
+
+    typedef QuickPID::Control Control;
+    typedef QuickPID::Action Action;
+    typedef QuickPID::pMode pMode;
+    typedef QuickPID::dMode dMode;
+    typedef QuickPID::iAwMode iAwMode;
+
+    // Constructor. Links the PID to Input, Output, Setpoint and initial tuning parameters.
+    BasicQuickPID(float *Input, float *Output, float *Setpoint, float Kp = 0, float Ki = 0, float Kd = 0,
+                  tGetTimeMicros getMicros = QUICKPID_DEFAULT_CLOCK) {
+      myOutput = Output;
+      myInput = Input;
+      mySetpoint = Setpoint;
+      _getMicros = getMicros;
+      SetOutputLimits(0, 255);  // same default as Arduino PWM limit
+      SetTunings(Kp, Ki, Kd);
+    }
+
+    // Sets PID mode to manual (0), automatic (1) or timer (2).
+    void SetMode(Control Mode, tGetTimeMicros getMicros = NULL) {
+      if (mode == Control::manual && Mode != Control::manual) Initialize();
+      mode = Mode;
+      if (getMicros != NULL) _getMicros = getMicros;
+      if (_getMicros != NULL) lastTime = _getMicros() - sampleTimeUs;
+    }
+
+    // Performs the PID calculation. Same timing behaviour as QuickPID::Compute().
+    bool Compute() {
+      if (mode == Control::manual) return false;
+      uint32_t now = lastTime;
+      if (mode == Control::automatic) {
+        if (_getMicros == NULL) return false;
+        now = _getMicros();
+        if ((uint32_t)(now - lastTime) < sampleTimeUs) return false;
+      }
+      *myOutput = QuickPIDStep(TAction, TpMode, TdMode, TiAwMode, *myInput, *mySetpoint,
+                               kp, ki, kd, outMin, outMax, outputSum, lastInput, lastError,
+                               error, pTerm, iTerm, dTerm);
+      lastTime = now;
+      return true;
+    }
+
+    // Sets and clamps the output to a specific range (0-255 by default).
+    void SetOutputLimits(float Min, float Max) {
+      if (Min >= Max) return;
+      outMin = Min;
+      outMax = Max;
+      if (mode != Control::manual) {
+        *myOutput = CONSTRAIN(*myOutput, outMin, outMax);
+        outputSum = CONSTRAIN(outputSum, outMin, outMax);
+      }
+    }
+
+    // Sets the tunings. The controller modes are fixed by the template parameters.
+    void SetTunings(float Kp, float Ki, float Kd) {
+      if (Kp < 0 || Ki < 0 || Kd < 0) return;
+      dispKp = Kp; dispKi = Ki; dispKd = Kd;
+      float SampleTimeSec = (float)sampleTimeUs / 1000000;
+      kp = Kp;
+      ki = Ki * SampleTimeSec;
+      kd = Kd / SampleTimeSec;
+    }
+
+    // Sets the sample time in microseconds with which each PID calculation is performed. Default is 100000 µs.
+    void SetSampleTimeUs(uint32_t NewSampleTimeUs) {
+      if (NewSampleTimeUs > 0) {
+        float ratio = (float)NewSampleTimeUs / (float)sampleTimeUs;
+        ki *= ratio;
+        kd /= ratio;
+        sampleTimeUs = NewSampleTimeUs;
+      }
+    }
+
+    // PID Query functions ****************************************************************************************
+    float GetKp() { return dispKp; }
+    float GetKi() { return dispKi; }
+    float GetKd() { return dispKd; }
+    float GetPterm() { return pTerm; }
+    float GetIterm() { return iTerm; }
+    float GetDterm() { return dTerm; }
+    uint8_t GetMode() { return static_cast<uint8_t>(mode); }
+    uint8_t GetDirection() { return static_cast<uint8_t>(TAction); }
+    uint8_t GetPmode() { return static_cast<uint8_t>(TpMode); }
+    uint8_t GetDmode() { return static_cast<uint8_t>(TdMode); }
+    uint8_t GetAwMode() { return static_cast<uint8_t>(TiAwMode); }
+
+  private:
+
+    void Initialize() {
+      outputSum = CONSTRAIN(*myOutput, outMin, outMax);
+      lastInput = *myInput;
+      lastError = 0;
+    }
+
+    float dispKp = 0;
+    float dispKi = 0;
+    float dispKd = 0;
+    float pTerm = 0;
+    float iTerm = 0;
+    float dTerm = 0;
+
+    float kp, ki, kd;
+
+    float *myInput;
+    float *myOutput;
+    float *mySetpoint;
+
+    tGetTimeMicros _getMicros;
+    Control mode = Control::manual;
+
+    uint32_t sampleTimeUs = 100000;  // 0.1 sec default
+    uint32_t lastTime = 0;
+    float outputSum = 0, outMin, outMax, error = 0, lastError = 0, lastInput = 0;
+
+}; // class BasicQuickPID
+#endif // BasicQuickPID.h
@@ -6,114 +6,325 @@
 
 #include "QuickPID.h"
 
+#ifndef QuickPID_cpp
+#define QuickPID_cpp
+
+#include "QuickPIDTrace.h"
+
 /* Constructor ********************************************************************
    The parameters specified here are those for for which we can't set up
-   reliable defaults, so we need to have the user set them.
+   reliable defaults, so we need to have the user set them. The settings are
+   scaled by QuickPIDConfig, as for a constexpr configuration, and then the
+   clock is read so the first Compute() in automatic mode runs immediately.
  **********************************************************************************/
-QuickPID::QuickPID(float* Input, float* Output, float* Setpoint,
-                   float Kp = 0, float Ki = 0, float Kd = 0,
-                   pMode pMode = pMode::pOnError,
-                   dMode dMode = dMode::dOnMeas,
-                   iAwMode iAwMode = iAwMode::iAwCondition,
-                   Action Action = Action::direct,
-                   tGetTimeMicros getMicros = NULL) {
-
-  myOutput = Output;
-  myInput = Input;
-  mySetpoint = Setpoint;
-  mode = Control::manual;
-  _getMicros = getMicros;
-
-  QuickPID::SetOutputLimits(0, 255);  // same default as Arduino PWM limit
-  sampleTimeUs = 100000;              // 0.1 sec default
-  QuickPID::SetControllerDirection(Action);
-  QuickPID::SetTunings(Kp, Ki, Kd, pMode, dMode, iAwMode);
+QUICKPID_INLINE QuickPID::QuickPID(float* Input, float* Output, float* Setpoint,
+                                   float Kp, float Ki, float Kd,
+                                   pMode pMode, dMode dMode, iAwMode iAwMode, Action Action,
+                                   tGetTimeMicros getMicros)
+  : QuickPID::QuickPID(Input, Output, Setpoint,
+                       QuickPIDConfig(Kp, Ki, Kd, pMode, dMode, iAwMode, Action, 0, 255, 100000, getMicros, 1000000)) {
 
   if( _getMicros != NULL ) {
-    lastTime = _getMicros() - sampleTimeUs;
+    lastTime = _getMicros() - sampleTicks;
   }
 }
 
 /* Constructor *********************************************************************
    To allow using pOnError, dOnMeas and iAwCondition without explicitly saying so.
  **********************************************************************************/
-QuickPID::QuickPID(float* Input, float* Output, float* Setpoint,
-                   float Kp, float Ki, float Kd, Action Action)
+QUICKPID_INLINE QuickPID::QuickPID(float* Input, float* Output, float* Setpoint,
+                                   float Kp, float Ki, float Kd, Action Action)
   : QuickPID::QuickPID(Input, Output, Setpoint, Kp, Ki, Kd,
-                       pmode = pMode::pOnError,
-                       dmode = dMode::dOnMeas,
-                       iawmode = iAwMode::iAwCondition,
-                       action = Action) {
+                       pMode::pOnError, dMode::dOnMeas, iAwMode::iAwCondition, Action) {
 }
 
 /* Constructor *********************************************************************
    Simplified constructor which uses defaults for remaining parameters.
  **********************************************************************************/
-QuickPID::QuickPID(float* Input, float* Output, float* Setpoint)
-  : QuickPID::QuickPID(Input, Output, Setpoint, dispKp, dispKi, dispKd,
-                       pmode = pMode::pOnError,
-                       dmode = dMode::dOnMeas,
-                       iawmode = iAwMode::iAwCondition,
-                       action = Action::direct) {
+QUICKPID_INLINE QuickPID::QuickPID(float* Input, float* Output, float* Setpoint)
+  : QuickPID::QuickPID(Input, Output, Setpoint, 0, 0, 0,
+                       pMode::pOnError, dMode::dOnMeas, iAwMode::iAwCondition, Action::direct) {
+}
+
+/* Step(....) **********************************************************************
+   The PID math shared by the Compute() variants. Without an extension it's
+   QuickPIDStep() alone, and StepExtension() adds the optional stages. With
+   QUICKPID_STATS, the calculation is also counted here, so every Compute()
+   variant is covered.
+ **********************************************************************************/
+QUICKPID_INLINE float QuickPID::Step(float input, float setpoint, float stepKi, float stepKd, float dtSec, float invDtSec, bool stamped) {
+#if defined(QUICKPID_STATS)
+  bool aw = false;
+  bool *awActive = &aw;
+#else
+  bool *awActive = NULL;
+#endif
+#if defined(QUICKPID_KAHAN_SUM)
+  float *comp = &sumComp;
+#else
+  float *comp = NULL;
+#endif
+  float output;
+  if (ext == NULL) {
+    output = QuickPIDStep(action, pmode, dmode, iawmode, input, setpoint,
+                          kp, stepKi, stepKd, outMin, outMax, outputSum, lastInput, lastError,
+                          error, pTerm, iTerm, dTerm, (float *)NULL, 1.0f, awActive, 0.0f, 1.0f, comp);
+    hold = false;
+  } else {
+    output = StepExtension(*ext, input, setpoint, stepKi, stepKd, dtSec, invDtSec, stamped, awActive, comp);
+  }
+#if defined(QUICKPID_STATS)
+  stats.computed++;
+  if (output >= outMax || output <= outMin) stats.saturated++;
+  if (aw) stats.antiWindup++;
+  if (hold) stats.held++;
+#endif
+  return output;
+}
+
+/* StepExtension(.........) ********************************************************
+   Step() with the optional stages. The input filter and the derivative filter
+   use precomputed coefficients and add one multiply-add each when enabled. A
+   linked trace gets the sample stamped with lastTime when the caller has just
+   set it (stamped), otherwise with the trace's push count, so the calculation
+   never reads the clock. The setpoint ramp, the feed-forward derivatives and
+   the output rate limit use the sample time, or dtSec and invDtSec when they
+   are given. When the rate limit holds the output back, this sample's
+   integration is undone if it pushed further in the limited direction, or
+   with iAwBackCalc the difference is back-calculated. Inside the deadband,
+   the previous output and the integral are held, and hold is set, as it is
+   when the output changed less than the threshold.
+ **********************************************************************************/
+QUICKPID_INLINE float QuickPID::StepExtension(QuickPIDExtension &x, float input, float setpoint, float stepKi, float stepKd,
+                                              float dtSec, float invDtSec, bool stamped, bool *awActive, float *comp) {
+  if (x.inAlpha < 1) {
+    x.inFiltered += x.inAlpha * (input - x.inFiltered);
+    input = x.inFiltered;
+  }
+  if (x.rampRate > 0) {
+    float maxStep = (dtSec > 0) ? x.rampRate * dtSec : x.rampStep;
+    x.rampSetpoint += CONSTRAIN(setpoint - x.rampSetpoint, -maxStep, maxStep);
+    setpoint = x.rampSetpoint;
+  }
+  if (x.ffKv != 0 || x.ffKa != 0 || x.myFeedForward != NULL) {
+    float velocity = (setpoint - x.lastSetpoint) * ((invDtSec > 0) ? invDtSec : x.invSampleTimeSec);
+    float acceleration = (velocity - x.lastVelocity) * ((invDtSec > 0) ? invDtSec : x.invSampleTimeSec);
+    x.ffTerm = x.ffKv * velocity + x.ffKa * acceleration;
+    if (x.myFeedForward != NULL) x.ffTerm += *x.myFeedForward;
+    x.lastSetpoint = setpoint;
+    x.lastVelocity = velocity;
+  }
+  float output;
+  bool inBand = false;
+  if (x.deadband > 0) {
+    float e = setpoint - input;
+    inBand = (e <= x.deadband && e >= -x.deadband);
+  }
+  if (inBand) {  // hold the output and the integral, the derivative state follows the input
+    error = (action == Action::reverse) ? input - setpoint : setpoint - input;
+    lastError = error;
+    lastInput = input;
+    iTerm = 0;
+    output = x.lastOutput;
+  } else {
+    output = QuickPIDStep(action, pmode, dmode, iawmode, input, setpoint,
+                          kp, stepKi, stepKd, outMin, outMax, outputSum, lastInput, lastError,
+                          error, pTerm, iTerm, dTerm,
+                          (x.dAlpha < 1) ? &x.dFiltered : (float *)NULL, x.dAlpha, awActive, x.ffTerm, x.trackGain, comp);
+  }
+  if (x.slewRate > 0) {
+    float maxDelta = (dtSec > 0) ? x.slewRate * dtSec : x.slewStep;
+    float limited = CONSTRAIN(output, x.lastOutput - maxDelta, x.lastOutput + maxDelta);
+    if (limited != output) {
+      if (iawmode == iAwMode::iAwBackCalc) outputSum += x.trackGain * (limited - output);
+      else if (iawmode != iAwMode::iAwOff) {
+        if ((limited - output) * iTerm < 0) outputSum -= iTerm;
+        outputSum = CONSTRAIN(outputSum, outMin - x.ffTerm, outMax - x.ffTerm);
+      }
+      if (awActive != NULL) *awActive = true;
+      output = limited;
+    }
+  }
+  x.lastOutput = output;
+  hold = inBand;
+  if (x.outThreshold > 0) {
+    float change = output - sentOutput;
+    if (change < x.outThreshold && change > -x.outThreshold) hold = true;
+  }
+  if (x.trace != NULL) {
+    QuickPIDSample sample;
+    sample.time = stamped ? lastTime : x.trace->GetPushed();
+    sample.input = input;
+    sample.setpoint = setpoint;
+    sample.pTerm = pTerm;
+    sample.iTerm = iTerm;
+    sample.dTerm = dTerm;
+    sample.output = output;
+    x.trace->Push(sample);
+  }
+  return output;
+}
+
+
+#if defined(QUICKPID_STATS)
+/* StatsTimeStep(.) ****************************************************************
+   Records the time between calculations, from the timestamp Compute() or
+   Compute(nowUs) already has, so the counters don't read the clock. The sum
+   stays 32 bits: when it would wrap, the sum and count are halved, which
+   keeps the average.
+ **********************************************************************************/
+QUICKPID_INLINE void QuickPID::StatsTimeStep(uint32_t dt) {
+  if (dt < stats.dtMin) stats.dtMin = dt;
+  if (dt > stats.dtMax) stats.dtMax = dt;
+  if (stats.dtSum + dt < stats.dtSum) {
+    stats.dtSum >>= 1;
+    stats.dtCount >>= 1;
+  }
+  stats.dtSum += dt;
+  stats.dtCount++;
 }
+#endif
 
 /* Compute() ***********************************************************************
    This function should be called every time "void loop()" executes. The function
    will decide whether a new PID Output needs to be computed. Returns true
-   when the output is computed, false when nothing has been done.
+   when a new output is written, false when nothing has been done or the
+   output is held by the deadband or output threshold.
  **********************************************************************************/
-bool QuickPID::Compute() {
-  uint32_t now;
+QUICKPID_INLINE bool QuickPID::Compute() {
+  uint32_t now = lastTime;
   uint32_t timeChange = 0;
   if (mode == Control::manual) return false;
-  if ((mode == Control::automatic) && (_getMicros != NULL) ) {
+  bool clocked = (mode == Control::automatic) && (_getMicros != NULL);
+  if (clocked) {
     now = _getMicros();
-    timeChange = (now - lastTime);
+    timeChange = (now - lastTime);  // unsigned, so correct across clock wrap
   }
-  if (mode == Control::timer || timeChange >= sampleTimeUs) {
-
-    float input = *myInput;
-    float dInput = input - lastInput;
-    if (action == Action::reverse) dInput = -dInput;
-
-    error = *mySetpoint - input;
-    if (action == Action::reverse) error = -error;
-    float dError = error - lastError;
-
-    float peTerm = kp * error;
-    float pmTerm = kp * dInput;
-    if (pmode == pMode::pOnError) pmTerm = 0;
-    else if (pmode == pMode::pOnMeas) peTerm = 0;
-    else { //pOnErrorMeas
-      peTerm *= 0.5f;
-      pmTerm *= 0.5f;
-    }
-    pTerm = peTerm - pmTerm; // used by GetDterm()
-    iTerm =  ki  * error;
-    if (dmode == dMode::dOnError) dTerm = kd * dError;
-    else dTerm = -kd * dInput; // dOnMeas
-
-    //condition anti-windup (default)
-    if (iawmode == iAwMode::iAwCondition) {
-      bool aw = false;
-      float iTermOut = (peTerm - pmTerm) + ki * (iTerm + error);
-      if (iTermOut > outMax && dError > 0) aw = true;
-      else if (iTermOut < outMin && dError < 0) aw = true;
-      if (aw && ki) iTerm = CONSTRAIN(iTermOut, -outMax, outMax);
+  if (mode == Control::timer || timeChange >= sampleTicks) {
+    lastTime = now;
+#if defined(QUICKPID_STATS)
+    if (clocked && stats.computed > 0) StatsTimeStep(timeChange);
+#endif
+    float output = Step(*myInput, *mySetpoint, ki, kd, 0, 0, clocked);
+#if defined(QUICKPID_STATS) && defined(QUICKPID_STATS_EXEC)
+    if (clocked) {  // timed from the clock read above
+      uint32_t exec = _getMicros() - now;
+      if (exec > stats.execMax) stats.execMax = exec;
     }
+#endif
+    return Publish(output);
+  }
+#if defined(QUICKPID_STATS)
+  stats.skipped++;
+#endif
+  return false;
+}
 
-    // by default, compute output as per PID_v1
-    outputSum += iTerm;                                                 // include integral amount
-    if (iawmode == iAwMode::iAwOff) outputSum -= pmTerm;                // include pmTerm (no anti-windup)
-    else outputSum = CONSTRAIN(outputSum - pmTerm, outMin, outMax);     // include pmTerm and clamp
-    *myOutput = CONSTRAIN(outputSum + peTerm + dTerm, outMin, outMax);  // include dTerm, clamp and drive output
+/* Compute(nowUs) *****************************************************************
+   Variable time step version of Compute(). The integral and derivative gains are
+   scaled by the actual elapsed time. Time steps from a scheduler tend to repeat,
+   so the reciprocals of the two most recent time steps are cached, which
+   avoids a divide on most calls. The first call after initializing uses the
+   sample time.
+ **********************************************************************************/
+QUICKPID_INLINE bool QuickPID::Compute(uint32_t nowUs) {
+  if (mode == Control::manual) return false;
+  uint32_t dt = dtValid ? (nowUs - lastTime) : sampleTimeUs;
+  if (dt == 0) return false;
+  if (dt != dtCacheUs[0]) {
+    float inv1 = (dt == dtCacheUs[1]) ? dtCacheInv[1] : 1000000.0f / (float)dt;
+    dtCacheUs[1] = dtCacheUs[0];
+    dtCacheInv[1] = dtCacheInv[0];
+    dtCacheUs[0] = dt;
+    dtCacheInv[0] = inv1;
+  }
+  float inv = dtCacheInv[0];
+  float dtki = dispKi * ((float)dt * 0.000001f);
+  float dtkd = dispKd * inv;
 
-    lastError = error;
-    lastInput = input;
-    lastTime = now;
-    return true;
+#if defined(QUICKPID_STATS)
+  if (dtValid) StatsTimeStep(dt);
+#endif
+  lastTime = nowUs;
+  dtValid = true;
+  return Publish(Step(*myInput, *mySetpoint, dtki, dtkd, (float)dt * 0.000001f, inv, true));
+}
+
+/* ComputeFromISR() ****************************************************************
+   The timing-free Compute() path for calling from a timer interrupt. The input
+   and setpoint are read once into locals, so an ISR reading them doesn't see a
+   half-written value from another part of the calculation.
+ **********************************************************************************/
+QUICKPID_INLINE bool QuickPID::ComputeFromISR() {
+  if (mode == Control::manual) return false;
+  float input = *myInput;
+  float setpoint = *mySetpoint;
+  return Publish(Step(input, setpoint, ki, kd));
+}
+
+/* ComputeBatch(....) **************************************************************
+   Without an extension, or with its input filter, setpoint ramp, feed-forward,
+   rate limit, hold options and trace off, and without the counters, Step() is
+   just QuickPIDStep(). The batch then
+   runs QuickPIDStep() directly with the state in locals, so the state isn't
+   stored and reloaded around each Output store, which could alias it.
+ **********************************************************************************/
+QUICKPID_INLINE size_t QuickPID::ComputeBatch(const float *Input, const float *Setpoint, float *Output, size_t Count) {
+  if (mode == Control::manual || Count == 0) return 0;
+  QuickPIDExtension *x = ext;
+  bool plain = (x == NULL || (x->inAlpha >= 1 && x->rampRate == 0 && x->ffKv == 0 && x->ffKa == 0 &&
+                              x->myFeedForward == NULL && x->slewRate == 0 && x->deadband == 0 &&
+                              x->outThreshold == 0 && x->trace == NULL));
+#if defined(QUICKPID_STATS)
+  plain = false;
+#endif
+  if (!plain) {
+    for (size_t i = 0; i < Count; i++) Output[i] = Compute(Input[i], Setpoint[i]);
+    return Count;
+  }
+  tQuickPIDSum sum = outputSum;
+  float in = lastInput, err = lastError;
+  float df = (x != NULL) ? x->dFiltered : 0;
+  float dAlpha = (x != NULL) ? x->dAlpha : 1;
+  float trackGain = (x != NULL) ? x->trackGain : 1;
+  float e, p, it, d;  // written by every step
+  float *dFilter = (dAlpha < 1) ? &df : (float *)NULL;
+#if defined(QUICKPID_KAHAN_SUM)
+  float c = sumComp;
+  float *comp = &c;
+#else
+  float *comp = NULL;
+#endif
+  float output = sentOutput;
+  for (size_t i = 0; i < Count; i++) {
+    output = QuickPIDStep(action, pmode, dmode, iawmode, Input[i], Setpoint[i],
+                          kp, ki, kd, outMin, outMax, sum, in, err, e, p, it, d,
+                          dFilter, dAlpha, (bool *)NULL, 0.0f, trackGain, comp);
+    Output[i] = output;
+  }
+  outputSum = sum;
+  lastInput = in; lastError = err; error = e;
+  pTerm = p; iTerm = it; dTerm = d;
+#if defined(QUICKPID_KAHAN_SUM)
+  sumComp = c;
+#endif
+  if (x != NULL) {
+    x->dFiltered = df;
+    x->lastOutput = output;
   }
-  else return false;
+  sentOutput = output;
+  hold = false;
+  return Count;
+}
+
+/* Publish(.) **********************************************************************
+   Writes a new output, unless the last calculation held it.
+ **********************************************************************************/
+QUICKPID_INLINE bool QuickPID::Publish(float output) {
+  if (hold) return false;
+  *myOutput = output;
+  sentOutput = output;
+  return true;
 }
 
 /* SetTunings(....)************************************************************
@@ -121,10 +332,8 @@ bool QuickPID::Compute() {
   it's called automatically from the constructor, but tunings can also
   be adjusted on the fly during normal operation.
 ******************************************************************************/
-void QuickPID::SetTunings(float Kp, float Ki, float Kd,
-                          pMode pMode = pMode::pOnError,
-                          dMode dMode = dMode::dOnMeas,
-                          iAwMode iAwMode = iAwMode::iAwCondition) {
+QUICKPID_INLINE void QuickPID::SetTunings(float Kp, float Ki, float Kd,
+                                          pMode pMode, dMode dMode, iAwMode iAwMode) {
 
   if (Kp < 0 || Ki < 0 || Kd < 0) return;
   pmode = pMode; dmode = dMode; iawmode = iAwMode;
@@ -138,19 +347,21 @@ void QuickPID::SetTunings(float Kp, float Ki, float Kd,
 /* SetTunings(...)************************************************************
   Set Tunings using the last remembered pMode, dMode and iAwMode settings.
 ******************************************************************************/
-void QuickPID::SetTunings(float Kp, float Ki, float Kd) {
+QUICKPID_INLINE void QuickPID::SetTunings(float Kp, float Ki, float Kd) {
   SetTunings(Kp, Ki, Kd, pmode, dmode, iawmode);
 }
 
 /* SetSampleTime(.)***********************************************************
   Sets the period, in microseconds, at which the calculation is performed.
 ******************************************************************************/
-void QuickPID::SetSampleTimeUs(uint32_t NewSampleTimeUs) {
+QUICKPID_INLINE void QuickPID::SetSampleTimeUs(uint32_t NewSampleTimeUs) {
   if (NewSampleTimeUs > 0) {
     float ratio  = (float)NewSampleTimeUs / (float)sampleTimeUs;
     ki *= ratio;
     kd /= ratio;
     sampleTimeUs = NewSampleTimeUs;
+    SetSampleTicks();
+    SetFilterCoefficients();
   }
 }
 
@@ -158,7 +369,7 @@ void QuickPID::SetSampleTimeUs(uint32_t NewSampleTimeUs) {
   The PID controller is designed to vary its output within a given range.
   By default this range is 0-255, the Arduino PWM range.
 ******************************************************************************/
-void QuickPID::SetOutputLimits(float Min, float Max) {
+QUICKPID_INLINE void QuickPID::SetOutputLimits(float Min, float Max) {
   if (Min >= Max) return;
   outMin = Min;
   outMax = Max;
@@ -172,34 +383,77 @@ void QuickPID::SetOutputLimits(float Min, float Max) {
 /* SetMode(.)*****************************************************************
   Sets the controller mode to manual (0), automatic (1) or timer (2)
   when the transition from manual to automatic or timer occurs, the
-  controller is automatically initialized.
+  controller is automatically initialized. A new microsecond clock can
+  be given, otherwise the current clock is kept.
 ******************************************************************************/
-void QuickPID::SetMode(Control Mode, tGetTimeMicros getMicros = NULL) {
+QUICKPID_INLINE void QuickPID::SetMode(Control Mode, tGetTimeMicros getMicros) {
   if (mode == Control::manual && Mode != Control::manual) { // just went from manual to automatic or timer
     QuickPID::Initialize();
   }
   mode = Mode;
-  _getMicros = NULL;
-  if( _getMicros != NULL ) {
-    lastTime = _getMicros() - sampleTimeUs;
-  }
+  if (getMicros != NULL) SetClock(getMicros);
+  else if (_getMicros != NULL) lastTime = _getMicros() - sampleTicks;
+}
+
+/* SetClock(..)***************************************************************
+  Sets the clock polled in automatic mode and its rate, then converts the
+  sample time to clock ticks so Compute() only needs a subtraction and a
+  compare. The next Compute() in automatic mode runs immediately.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetClock(tGetTimeMicros getTicks, uint32_t TicksPerSec) {
+  if (TicksPerSec == 0) return;
+  _getMicros = getTicks;
+  ticksPerSec = TicksPerSec;
+  SetSampleTicks();
+  if (_getMicros != NULL) lastTime = _getMicros() - sampleTicks;
+}
+
+QUICKPID_INLINE void QuickPID::SetSampleTicks() {
+  uint64_t ticks = (uint64_t)sampleTimeUs * ticksPerSec / 1000000;
+  sampleTicks = (ticks > 0x7FFFFFFF) ? 0x7FFFFFFF : (ticks == 0) ? 1 : (uint32_t)ticks;
 }
 
 /* Initialize()****************************************************************
   Does all the things that need to happen to ensure a bumpless transfer
   from manual to automatic mode.
 ******************************************************************************/
-void QuickPID::Initialize() {
-  outputSum = *myOutput;
-  lastInput = *myInput;
-  outputSum = CONSTRAIN(outputSum, outMin, outMax);
+QUICKPID_INLINE void QuickPID::Initialize() {
+  bool resume = restored;
+  float in = lastInput, err = lastError;
+  Initialize(*myInput, *myOutput, *mySetpoint);
+  if (resume) {  // keep the last input and error restored by SetState()
+    lastInput = in;
+    if (ext != NULL) ext->inFiltered = in;
+    lastError = err;
+  }
+}
+
+QUICKPID_INLINE void QuickPID::Initialize(float Input, float Output, float Setpoint) {
+  outputSum = CONSTRAIN(Output, outMin, outMax);
+#if defined(QUICKPID_KAHAN_SUM)
+  sumComp = 0;
+#endif
+  lastInput = Input;
+  lastError = 0;
+  dtValid = false;
+  sentOutput = outputSum;
+  if (ext != NULL) {
+    QuickPIDExtension &x = *ext;
+    x.inFiltered = Input;
+    x.dFiltered = 0;
+    x.rampSetpoint = Input;  // the ramp starts from the process value
+    x.lastSetpoint = (x.rampRate > 0) ? x.rampSetpoint : Setpoint;
+    x.lastVelocity = 0;
+    x.lastOutput = outputSum;
+  }
+  restored = false;
 }
 
 /* SetControllerDirection(.)**************************************************
   The PID will either be connected to a direct acting process (+Output leads
   to +Input) or a reverse acting process(+Output leads to -Input).
 ******************************************************************************/
-void QuickPID::SetControllerDirection(Action Action) {
+QUICKPID_INLINE void QuickPID::SetControllerDirection(Action Action) {
   action = Action;
 }
 
@@ -207,7 +461,7 @@ void QuickPID::SetControllerDirection(Action Action) {
   Sets the computation method for the proportional term, to compute based
   either on error (default), on measurement, or the average of both.
 ******************************************************************************/
-void QuickPID::SetProportionalMode(pMode pMode) {
+QUICKPID_INLINE void QuickPID::SetProportionalMode(pMode pMode) {
   pmode = pMode;
 }
 
@@ -215,54 +469,186 @@ void QuickPID::SetProportionalMode(pMode pMode) {
   Sets the computation method for the derivative term, to compute based
   either on error or on measurement (default).
 ******************************************************************************/
-void QuickPID::SetDerivativeMode(dMode dMode) {
+QUICKPID_INLINE void QuickPID::SetDerivativeMode(dMode dMode) {
   dmode = dMode;
 }
 
+/* SetDerivativeFilter(.)****************************************************
+  Sets the time constant of the first order low-pass filter on the
+  derivative term. 0 disables it.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetDerivativeFilter(float TimeConstantSec) {
+  if (TimeConstantSec < 0 || ext == NULL) return;
+  ext->dFilterTc = TimeConstantSec;
+  SetFilterCoefficients();
+}
+
+/* SetInputFilter(.)**********************************************************
+  Sets the time constant of the exponential moving average filter on the
+  input. 0 disables it.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetInputFilter(float TimeConstantSec) {
+  if (TimeConstantSec < 0 || ext == NULL) return;
+  ext->inFilterTc = TimeConstantSec;
+  if (ext->inAlpha >= 1) ext->inFiltered = *myInput; // start from the current input
+  SetFilterCoefficients();
+}
+
+/* SetFilterCoefficients()****************************************************
+  The discrete filter coefficient for time constant Tc at sample time Ts is
+  Ts / (Tc + Ts), so the per sample update is a single multiply-add. The
+  setpoint ramp and output rate limit steps per sample and the
+  back-calculation gain Ts / Tt (at most 1) are also precomputed here, in the
+  extension.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetFilterCoefficients() {
+  if (ext == NULL) return;
+  QuickPIDExtension &x = *ext;
+  float SampleTimeSec = (float)sampleTimeUs / 1000000;
+  x.invSampleTimeSec = 1.0f / SampleTimeSec;
+  x.rampStep = x.rampRate * SampleTimeSec;
+  x.slewStep = x.slewRate * SampleTimeSec;
+  x.trackGain = (x.trackTimeSec > SampleTimeSec) ? SampleTimeSec / x.trackTimeSec : 1;
+  x.dAlpha = (x.dFilterTc > 0) ? SampleTimeSec / (x.dFilterTc + SampleTimeSec) : 1;
+  x.inAlpha = (x.inFilterTc > 0) ? SampleTimeSec / (x.inFilterTc + SampleTimeSec) : 1;
+}
+
 /* SetAntiWindupMode(.)*******************************************************
   Sets the integral anti-windup mode to one of iAwClamp, which clamps
   the output after adding integral and proportional (on measurement) terms,
   or iAwCondition (default), which provides some integral correction, prevents
   deep saturation and reduces overshoot.
-  Option iAwOff disables anti-windup altogether.
+  Option iAwOff disables anti-windup altogether. With iAwBackCalc, the
+  integral sum isn't clamped; the amount by which the output is limited is
+  fed back into it instead, scaled by Ts / Tt (see SetBackCalculation()).
 ******************************************************************************/
-void QuickPID::SetAntiWindupMode(iAwMode iAwMode) {
+QUICKPID_INLINE void QuickPID::SetAntiWindupMode(iAwMode iAwMode) {
   iawmode = iAwMode;
 }
 
-/* Status Functions************************************************************
-  These functions query the internal state of the PID.
+/* SetBackCalculation(.)******************************************************
+  A tracking time constant Tt shorter than the sample time (or 0) removes the
+  whole excess each sample. A longer one lets the integral recover gradually.
 ******************************************************************************/
-float QuickPID::GetKp() {
-  return dispKp;
-}
-float QuickPID::GetKi() {
-  return dispKi;
+QUICKPID_INLINE void QuickPID::SetBackCalculation(float TrackingTimeSec) {
+  if (TrackingTimeSec < 0 || ext == NULL) return;
+  ext->trackTimeSec = TrackingTimeSec;
+  SetFilterCoefficients();
 }
-float QuickPID::GetKd() {
-  return dispKd;
+
+/* SetDeadband(.)/SetOutputThreshold(.)**************************************
+  0 disables either one.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetDeadband(float Band) {
+  if (Band >= 0 && ext != NULL) ext->deadband = Band;
 }
-float QuickPID::GetPterm() {
-  return pTerm;
+
+QUICKPID_INLINE void QuickPID::SetOutputThreshold(float Delta) {
+  if (Delta >= 0 && ext != NULL) ext->outThreshold = Delta;
 }
-float QuickPID::GetIterm() {
-  return iTerm;
+
+/* SetOutputRateLimit(.)******************************************************
+  When the limit is enabled while running, it starts from the current Output.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetOutputRateLimit(float RatePerSec) {
+  if (RatePerSec < 0 || ext == NULL) return;
+  if (ext->slewRate == 0) ext->lastOutput = *myOutput;
+  ext->slewRate = RatePerSec;
+  SetFilterCoefficients();
 }
-float QuickPID::GetDterm() {
-  return dTerm;
+
+/* GetState(.)/SetState(.)********************************************************
+   The state is restored after the settings, since SetOutputLimits() and
+   SetSampleTimeUs() adjust it. The Output is set to the integral sum, so a
+   SetMode() from manual, whose Initialize() starts from the Output, keeps it.
+   In manual mode, the restored last input and error are also kept across
+   that Initialize(), so dOnError and dOnMeas resume without a derivative kick.
+ **********************************************************************************/
+QUICKPID_INLINE void QuickPID::GetState(QuickPIDState &State) {
+  State.kp = dispKp;
+  State.ki = dispKi;
+  State.kd = dispKd;
+  State.outMin = outMin;
+  State.outMax = outMax;
+  State.outputSum = outputSum;
+  State.lastInput = lastInput;
+  State.lastError = lastError;
+  State.sampleTimeUs = sampleTimeUs;
+  State.version = QUICKPID_STATE_VERSION;
+  State.action = static_cast<uint8_t>(action);
+  State.pmode = static_cast<uint8_t>(pmode);
+  State.dmode = static_cast<uint8_t>(dmode);
+  State.iawmode = static_cast<uint8_t>(iawmode);
 }
-uint8_t QuickPID::GetMode() {
-  return static_cast<uint8_t>(mode);
+
+QUICKPID_INLINE bool QuickPID::SetState(const QuickPIDState &State) {
+  if (State.version != QUICKPID_STATE_VERSION || State.outMin >= State.outMax || State.sampleTimeUs == 0 ||
+      State.kp < 0 || State.ki < 0 || State.kd < 0 || State.action > 1 || State.pmode > 2 ||
+      State.dmode > 1 || State.iawmode > 3 || !(State.outputSum == State.outputSum)) return false;
+  SetOutputLimits(State.outMin, State.outMax);
+  SetSampleTimeUs(State.sampleTimeUs);
+  SetControllerDirection(static_cast<Action>(State.action));
+  SetTunings(State.kp, State.ki, State.kd, static_cast<pMode>(State.pmode),
+             static_cast<dMode>(State.dmode), static_cast<iAwMode>(State.iawmode));
+  outputSum = CONSTRAIN(State.outputSum, outMin, outMax);
+#if defined(QUICKPID_KAHAN_SUM)
+  sumComp = 0;
+#endif
+  lastInput = State.lastInput;
+  lastError = State.lastError;
+  dtValid = false;
+  *myOutput = outputSum;
+  sentOutput = outputSum;
+  if (ext != NULL) {
+    ext->inFiltered = lastInput;
+    ext->dFiltered = 0;
+    ext->lastOutput = outputSum;
+  }
+  restored = (mode == Control::manual);
+  return true;
 }
-uint8_t QuickPID::GetDirection() {
-  return static_cast<uint8_t>(action);
+
+/* SetSetpointRamp(.)*********************************************************
+  When the ramp is enabled while running, it starts from the current setpoint.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetSetpointRamp(float RatePerSec) {
+  if (RatePerSec < 0 || ext == NULL) return;
+  if (ext->rampRate == 0) ext->rampSetpoint = *mySetpoint;
+  ext->rampRate = RatePerSec;
+  SetFilterCoefficients();
 }
-uint8_t QuickPID::GetPmode() {
-  return static_cast<uint8_t>(pmode);
+
+/* SetFeedForward(...)********************************************************
+  The velocity and acceleration are differences of the setpoint used by the
+  calculation, so they are smooth when the setpoint ramp is enabled.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetFeedForward(float Kv, float Ka, float *FeedForward) {
+  if (ext == NULL) return;
+  QuickPIDExtension &x = *ext;
+  if (x.ffKv == 0 && x.ffKa == 0 && x.myFeedForward == NULL) {
+    x.lastSetpoint = (x.rampRate > 0) ? x.rampSetpoint : *mySetpoint;
+    x.lastVelocity = 0;
+  }
+  x.ffKv = Kv;
+  x.ffKa = Ka;
+  x.myFeedForward = FeedForward;
+  if (Kv == 0 && Ka == 0 && FeedForward == NULL) x.ffTerm = 0;
 }
-uint8_t QuickPID::GetDmode() {
-  return static_cast<uint8_t>(dmode);
+
+QUICKPID_INLINE void QuickPID::SetTrace(QuickPIDTrace *Trace) {
+  if (ext != NULL) ext->trace = Trace;
 }
-uint8_t QuickPID::GetAwMode() {
-  return static_cast<uint8_t>(iawmode);
+
+/* SetExtension(.)************************************************************
+  The optional stages start from the controller's state, with their
+  coefficients computed for its sample time. Linking NULL removes them.
+******************************************************************************/
+QUICKPID_INLINE void QuickPID::SetExtension(QuickPIDExtension *Extension) {
+  ext = Extension;
+  if (ext == NULL) return;
+  ext->inFiltered = lastInput;
+  ext->lastOutput = sentOutput;
+  SetFilterCoefficients();
 }
+
+#endif // QuickPID_cpp
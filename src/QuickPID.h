@@ -2,12 +2,103 @@
 #ifndef QuickPID_h
 #define QuickPID_h
 
-typedef unsigned long (*tGetTimeMicros)(void);
+#include "QuickPIDClock.h"
 
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define MAX(a,b) ((a) < (b) ? (b) : (a))
 #define CONSTRAIN(x,a,b) MIN(MAX((x),(a)),(b))
 
+// With QUICKPID_HEADER_ONLY defined for the whole build, QuickPID.cpp is compiled as part of this header with
+// inline functions, so Compute() can be inlined into the caller. Otherwise it's a normal translation unit.
+#if defined(QUICKPID_HEADER_ONLY)
+#define QUICKPID_INLINE inline
+#else
+#define QUICKPID_INLINE
+#endif
+
+// Integral accumulator. With QUICKPID_DOUBLE_SUM the integral sum is a double, and with QUICKPID_KAHAN_SUM it's
+// a float with Kahan compensation, so that small integral steps of slow loops aren't lost to rounding. Define
+// one of them for the whole build. The rest of the calculation stays in float.
+#if defined(QUICKPID_DOUBLE_SUM) && defined(QUICKPID_KAHAN_SUM)
+#error "Define only one of QUICKPID_DOUBLE_SUM and QUICKPID_KAHAN_SUM"
+#endif
+#if defined(QUICKPID_DOUBLE_SUM)
+typedef double tQuickPIDSum;
+#else
+typedef float tQuickPIDSum;
+#endif
+
+#if defined(QUICKPID_STATS)
+/**********************************************************************************
+   Execution counters kept by every QuickPID when QUICKPID_STATS is defined for
+   the whole build (library and sketch, e.g. in the build flags). Without it,
+   the counters and the code updating them don't exist. Time steps come from
+   the timestamp the calculation already has: clock ticks in automatic mode
+   Compute(), microseconds in Compute(nowUs), none in timer mode, cascades or
+   ComputeFromISR(). The execution time costs a second clock read, so it's
+   only measured with QUICKPID_STATS_EXEC also defined, in automatic mode.
+ **********************************************************************************/
+struct QuickPIDStats {
+  uint32_t computed = 0;        // PID calculations performed
+  uint32_t skipped = 0;         // automatic mode Compute() calls before the sample time elapsed
+  uint32_t held = 0;            // calculations whose output was held by the deadband or output threshold
+  uint32_t saturated = 0;       // calculations with the output at a limit
+  uint32_t antiWindup = 0;      // calculations in which anti-windup limited the integral
+  uint32_t dtMin = 0xFFFFFFFF;  // shortest time between calculations
+  uint32_t dtMax = 0;           // longest time between calculations
+  uint32_t dtCount = 0;         // time steps in dtSum
+  uint32_t dtSum = 0;           // halved with dtCount before it wraps
+  uint32_t execMax = 0;         // worst case Compute() calculation time, with QUICKPID_STATS_EXEC
+
+  uint32_t dtAvg() const { return dtCount ? (uint32_t)(dtSum / dtCount) : 0; }
+};
+#endif
+
+// Serializable controller settings and state, for a warm start after a reset (see QuickPIDStore).
+struct QuickPIDState {
+  float kp, ki, kd;             // tunings as given to SetTunings()
+  float outMin, outMax;
+  float outputSum, lastInput, lastError;
+  uint32_t sampleTimeUs;
+  uint8_t version;              // QUICKPID_STATE_VERSION
+  uint8_t action, pmode, dmode, iawmode;
+};
+#define QUICKPID_STATE_VERSION 1
+
+class QuickPIDTrace;
+struct QuickPIDConfig;
+
+/**********************************************************************************
+   QuickPIDExtension holds the settings and state of QuickPID's optional
+   stages: the input and derivative filters, setpoint ramp, feed-forward,
+   output rate limit, back-calculation, deadband, output threshold, trace and
+   the Compute(nowUs) time step cache. Most loops use none of them, so they
+   aren't part of every controller. The memory is supplied by the user, like a
+   trace buffer, and linked with SetExtension() before the Set functions of
+   those stages, which do nothing without it.
+
+   QuickPIDExtension pidExtension;
+   myPID.SetExtension(&pidExtension);
+   myPID.SetDerivativeFilter(0.05);
+ **********************************************************************************/
+struct QuickPIDExtension {
+  float dFilterTc = 0, inFilterTc = 0;  // filter time constants in seconds, 0 is off
+  float dAlpha = 1, inAlpha = 1;        // filter coefficients for the sample time
+  float dFiltered = 0, inFiltered = 0;  // filter states
+  float rampRate = 0, rampStep = 0;     // setpoint ramp in units/s and units/sample, 0 is off
+  float rampSetpoint = 0;               // ramped setpoint
+  float ffKv = 0, ffKa = 0;             // feed-forward gains on setpoint velocity and acceleration
+  float *myFeedForward = NULL;          // external feed-forward value, NULL for none
+  float ffTerm = 0;                     // feed-forward component of output
+  float lastSetpoint = 0, lastVelocity = 0;
+  float invSampleTimeSec = 10;          // 1 / sample time
+  float trackTimeSec = 0, trackGain = 1; // back-calculation time constant, and Ts / Tt
+  float slewRate = 0, slewStep = 0;     // output rate limit in units/s and units/sample, 0 is off
+  float lastOutput = 0;                 // last calculated output
+  float deadband = 0, outThreshold = 0; // error deadband and output change threshold, 0 is off
+  QuickPIDTrace *trace = NULL;          // telemetry sink, NULL for none
+};
+
 class QuickPID {
 
   public:
@@ -16,13 +107,15 @@ class QuickPID {
     enum class Action : uint8_t {direct, reverse};                  // controller action
     enum class pMode : uint8_t {pOnError, pOnMeas, pOnErrorMeas};   // proportional mode
     enum class dMode : uint8_t {dOnError, dOnMeas};                 // derivative mode
-    enum class iAwMode : uint8_t {iAwCondition, iAwClamp, iAwOff};  // integral anti-windup mode
+    enum class iAwMode : uint8_t {iAwCondition, iAwClamp, iAwOff, iAwBackCalc};  // integral anti-windup mode
 
     // commonly used functions ************************************************************************************
 
     // Constructor. Links the PID to Input, Output, Setpoint, initial tuning parameters and control modes.
+    // Optionally sets a microsecond clock for automatic mode (micros() by default on Arduino).
     QuickPID(float *Input, float *Output, float *Setpoint, float Kp, float Ki, float Kd,
-             pMode pMode, dMode dMode, iAwMode iAwMode, Action Action);
+             pMode pMode, dMode dMode, iAwMode iAwMode, Action Action,
+             tGetTimeMicros getMicros = QUICKPID_DEFAULT_CLOCK);
 
     // Overload constructor links the PID to Input, Output, Setpoint, tuning parameters and control Action.
     // Uses defaults for remaining parameters.
@@ -31,13 +124,54 @@ class QuickPID {
     // Simplified constructor which uses defaults for remaining parameters.
     QuickPID(float *Input, float *Output, float *Setpoint);
 
-    // Sets PID mode to manual (0), automatic (1) or timer (2).
-    void SetMode(Control Mode, tGetTimeMicros* getTimeMicros);
+    // Constructor from a configuration (see QuickPIDConfig). The scaled gains and the sample time in clock ticks
+    // come precomputed from it, so with a constexpr configuration a global controller is initialized at compile
+    // time and has no constructor code to run at startup. SetMode() starts the clock.
+    constexpr QuickPID(float *Input, float *Output, float *Setpoint, const QuickPIDConfig &Config);
+
+    // Sets PID mode to manual (0), automatic (1) or timer (2). Optionally sets a new microsecond clock.
+    void SetMode(Control Mode, tGetTimeMicros getMicros = NULL);
+
+    // Sets the clock used in automatic mode and its rate in ticks per second, for example
+    // QuickPIDClock::cycleCount at the CPU clock rate. The clock must wrap over the full 32 bits.
+    void SetClock(tGetTimeMicros getTicks, uint32_t TicksPerSec = 1000000);
 
     // Performs the PID calculation. It should be called every time loop() cycles ON/OFF and calculation frequency
     // can be set using SetMode and SetSampleTime respectively.
     bool Compute();
 
+    // Performs the PID calculation unconditionally, without polling the time, for use inside a timer
+    // interrupt at a fixed rate. Input is read once and Output is written once. Not reentrant for one
+    // controller (don't call it from two interrupts). Returns false in manual mode, or when the output is held
+    // (see SetDeadband() and SetOutputThreshold()).
+    bool ComputeFromISR();
+
+    // Timestamp driven PID calculation for event driven schedulers. Computes on every call (except in manual
+    // mode) and scales the integral and derivative terms by the time elapsed since the previous call, instead
+    // of the sample time. Returns false if no time has elapsed or the output is held. Don't mix with automatic
+    // mode Compute().
+    bool Compute(uint32_t nowUs);
+
+    // Value-passing PID calculation. Computes on every call like timer mode, without reading or writing the
+    // Input, Output and Setpoint links, and returns the output (the previous output in manual mode, or when
+    // it's held by the deadband or output threshold).
+    float Compute(float Input, float Setpoint) {
+      if (mode != Control::manual) {
+        float output = Step(Input, Setpoint, ki, kd);
+        if (!hold) sentOutput = output;
+      }
+      return sentOutput;
+    }
+
+    // Runs Count value-passing calculations, one per sample of the Input and Setpoint arrays, into Output,
+    // for replaying recorded data. Same results as Count calls of Compute(Input[i], Setpoint[i]). Output may
+    // be the same array as Input. Returns the number of calculations, 0 in manual mode.
+    size_t ComputeBatch(const float *Input, const float *Setpoint, float *Output, size_t Count);
+
+    // Bumpless start from the given values instead of the linked variables, for use with the value-passing
+    // Compute() after SetMode() from manual.
+    void Initialize(float Input, float Output, float Setpoint);
+
     // Sets and clamps the output to a specific range (0-255 by default).
     void SetOutputLimits(float Min, float Max);
 
@@ -64,54 +198,338 @@ class QuickPID {
     // Sets the computation method for the derivative term, to compute based either on error or measurement (default).
     void SetDerivativeMode(dMode dMode);
 
+    // Links the QuickPIDExtension that holds the optional stages below, or NULL (default) for none.
+    void SetExtension(QuickPIDExtension *Extension);
+
+    // The following Set functions, up to SetTrace(), need a linked QuickPIDExtension and do nothing without one.
+
+    // Sets a first order low-pass filter on the derivative term, with the given time constant in seconds.
+    // This reduces derivative spikes from a noisy input. 0 (default) disables the filter.
+    void SetDerivativeFilter(float TimeConstantSec);
+
+    // Sets an exponential moving average filter on the input, with the given time constant in seconds.
+    // The filtered input is used for all terms. 0 (default) disables the filter.
+    void SetInputFilter(float TimeConstantSec);
+
+    // Limits the rate at which the setpoint used by the calculation follows Setpoint, in units per second.
+    // A large step then becomes a ramp. 0 (default) disables the ramp.
+    void SetSetpointRamp(float RatePerSec);
+
+    // Sets feed-forward gains on the velocity and acceleration of the (ramped) setpoint, and optionally links
+    // an external feed-forward value. The sum is added to the output before it's clamped. 0, 0, NULL disables it.
+    void SetFeedForward(float Kv, float Ka, float *FeedForward = NULL);
+
     // Sets the integral anti-windup mode to one of iAwClamp, which clamps the output after
     // adding integral and proportional (on measurement) terms, or iAwCondition (default), which
     // provides some integral correction, prevents deep saturation and reduces overshoot.
-    // Option iAwOff disables anti-windup altogether.
+    // Option iAwOff disables anti-windup altogether. iAwBackCalc (back-calculation) feeds the amount the
+    // output is limited by back into the integral sum, through SetBackCalculation().
     void SetAntiWindupMode(iAwMode iAwMode);
 
+    // Sets the tracking time constant in seconds of back-calculation anti-windup. 0 (default) removes the
+    // whole excess in one sample.
+    void SetBackCalculation(float TrackingTimeSec);
+
+    // Sets an error deadband: while |Setpoint - Input| is within Band, the output and the integral are held and
+    // Compute() returns false. 0 (default) disables it.
+    void SetDeadband(float Band);
+
+    // Sets the smallest output change that's written: a smaller change leaves Output as it was and Compute()
+    // returns false, so no new value needs to be sent. Changes add up until they reach Delta. 0 (default)
+    // disables it.
+    void SetOutputThreshold(float Delta);
+
+    // Limits the rate of change of the output, in units per second, for example to match an actuator's own
+    // rate limit. The limited direction stops integrating (or is back-calculated). 0 (default) disables it.
+    void SetOutputRateLimit(float RatePerSec);
+
+    // Copies the tunings, modes, limits, sample time and integral and derivative state into State.
+    void GetState(QuickPIDState &State);
+
+    // Restores a state saved with GetState() and resumes bumplessly from it, also across a following
+    // SetMode() from manual. Returns false, changing nothing, if State isn't valid.
+    bool SetState(const QuickPIDState &State);
+
+    // Links a QuickPIDTrace ring buffer that receives a sample of every calculation, or NULL (default) for none.
+    void SetTrace(QuickPIDTrace *Trace);
+
     // PID Query functions ****************************************************************************************
-    float GetKp();            // proportional gain
-    float GetKi();            // integral gain
-    float GetKd();            // derivative gain
-    float GetPterm();         // proportional component of output
-    float GetIterm();         // integral component of output
-    float GetDterm();         // derivative component of output
-    uint8_t GetMode();        // manual (0), automatic (1) or timer (2)
-    uint8_t GetDirection();   // direct (0), reverse (1)
-    uint8_t GetPmode();       // pOnError (0), pOnMeas (1), pOnErrorMeas (2)
-    uint8_t GetDmode();       // dOnError (0), dOnMeas (1)
-    uint8_t GetAwMode();      // iAwCondition (0, iAwClamp (1), iAwOff (2)
+    float GetKp() { return dispKp; }                   // proportional gain
+    float GetKi() { return dispKi; }                   // integral gain
+    float GetKd() { return dispKd; }                   // derivative gain
+    float GetPterm() { return pTerm; }                 // proportional component of output
+    float GetIterm() { return iTerm; }                 // integral component of output
+    float GetDterm() { return dTerm; }                 // derivative component of output
+    float GetFFterm() { return (ext != NULL) ? ext->ffTerm : 0; }  // feed-forward component of output
+    float GetRampSetpoint() {                          // setpoint used by the calculation, after the ramp
+      return (ext != NULL && ext->rampRate > 0) ? ext->rampSetpoint : *mySetpoint;
+    }
+    uint8_t GetMode() { return static_cast<uint8_t>(mode); }         // manual (0), automatic (1) or timer (2)
+    uint8_t GetDirection() { return static_cast<uint8_t>(action); }  // direct (0), reverse (1)
+    uint8_t GetPmode() { return static_cast<uint8_t>(pmode); }       // pOnError (0), pOnMeas (1), pOnErrorMeas (2)
+    uint8_t GetDmode() { return static_cast<uint8_t>(dmode); }       // dOnError (0), dOnMeas (1)
+    uint8_t GetAwMode() { return static_cast<uint8_t>(iawmode); }    // iAwCondition (0, iAwClamp (1), iAwOff (2),
+                                                                     // iAwBackCalc (3)
+
+#if defined(QUICKPID_STATS)
+    const QuickPIDStats &GetStats() { return stats; }  // execution counters
+    void ResetStats() { stats = QuickPIDStats(); }
+#endif
 
   private:
 
+    friend class QuickPIDIsr;
+    friend class QuickPIDGainSchedule;
+    template <uint8_t N> friend class QuickPIDCascade;
+    template <uint8_t N> friend class QuickPIDScheduler;
+
     void Initialize();
+    void SetSampleTicks();
+    void SetFilterCoefficients();
+    float Step(float input, float setpoint, float stepKi, float stepKd, float dtSec = 0, float invDtSec = 0,
+               bool stamped = false);
+    float StepExtension(QuickPIDExtension &x, float input, float setpoint, float stepKi, float stepKd,
+                        float dtSec, float invDtSec, bool stamped, bool *awActive, float *comp);
+    bool Publish(float output);
+#if defined(QUICKPID_STATS)
+    QuickPIDStats stats;
+    void StatsTimeStep(uint32_t dt);
+#endif
 
     float dispKp = 0;   // for defaults and display
     float dispKi = 0;
     float dispKd = 0;
-    float pTerm;
-    float iTerm;
-    float dTerm;
+    float pTerm = 0;
+    float iTerm = 0;
+    float dTerm = 0;
 
-    float kp;           // (P)roportional Tuning Parameter
-    float ki;           // (I)ntegral Tuning Parameter
-    float kd;           // (D)erivative Tuning Parameter
+    float kp = 0;       // (P)roportional Tuning Parameter
+    float ki = 0;       // (I)ntegral Tuning Parameter
+    float kd = 0;       // (D)erivative Tuning Parameter
 
     float *myInput;     // Pointers to the Input, Output, and Setpoint variables. This creates a
     float *myOutput;    // hard link between the variables and the PID, freeing the user from having
     float *mySetpoint;  // to constantly tell us what these values are. With pointers we'll just know.
 
-    tGetTimeMicros _getMicros; // Function to use in 'automatic' mode that allows polling of time since wakeup in microseconds
+    tGetTimeMicros _getMicros; // Function to use in 'automatic' mode that allows polling of time since wakeup in ticks
+    QuickPIDExtension *ext = NULL;   // optional stages, NULL for none
+    uint32_t ticksPerSec = 1000000;  // clock rate, 1000000 for a microsecond clock
+    uint32_t sampleTicks = 100000;   // sample time in clock ticks
 
     Control mode = Control::manual;
     Action action = Action::direct;
     pMode pmode = pMode::pOnError;
     dMode dmode = dMode::dOnMeas;
     iAwMode iawmode = iAwMode::iAwCondition;
+    bool dtValid = false;                 // false until Compute(nowUs) has a previous timestamp
+    bool hold = false;                    // the last calculation held the output
+    bool restored = false;                // SetState() ran in manual mode, for the next Initialize()
 
-    uint32_t sampleTimeUs, lastTime;
-    float outputSum, outMin, outMax, error, lastError, lastInput;
+    uint32_t sampleTimeUs = 100000, lastTime = 0;
+    uint32_t dtCacheUs[2] = {0, 0};       // recently seen time steps for Compute(nowUs) and
+    float dtCacheInv[2] = {0, 0};         // their reciprocals in 1/s, most recent first
+    float sentOutput = 0;                 // last output written or returned
+    tQuickPIDSum outputSum = 0;
+#if defined(QUICKPID_KAHAN_SUM)
+    float sumComp = 0;                    // Kahan compensation, the low order part lost from outputSum
+#endif
+    float outMin = 0, outMax = 255, error = 0, lastError = 0, lastInput = 0;
 
 }; // class QuickPID
+
+/**********************************************************************************
+   QuickPIDConfig holds a controller's gains, modes, output limits, sample time
+   and clock, with the gains scaled for the sample time and the sample time
+   converted to clock ticks by its constexpr functions. Each function returns
+   a copy with one setting changed and, like the QuickPID Set functions,
+   ignores invalid values. Declared constexpr, the whole configuration is
+   computed by the compiler, and a controller constructed from it needs no
+   divisions or function calls at startup.
+
+   constexpr QuickPIDConfig pidConfig = QuickPIDConfig()
+     .Tunings(2, 5, 1)
+     .OutputLimits(-100, 100)
+     .SampleTimeUs(10000);
+   QuickPID myPID(&Input, &Output, &Setpoint, pidConfig);
+ **********************************************************************************/
+struct QuickPIDConfig {
+
+    // Defaults are the same as QuickPID's: gains of 0, pOnError, dOnMeas, iAwCondition, direct, outputs of 0
+    // to 255 and a sample time of 100000 µs with the default clock.
+    constexpr QuickPIDConfig()
+      : QuickPIDConfig(0, 0, 0, QuickPID::pMode::pOnError, QuickPID::dMode::dOnMeas,
+                       QuickPID::iAwMode::iAwCondition, QuickPID::Action::direct, 0, 255, 100000,
+                       QUICKPID_DEFAULT_CLOCK, 1000000) {}
+
+    constexpr QuickPIDConfig Tunings(float Kp, float Ki, float Kd) const {
+      return QuickPIDConfig(Kp, Ki, Kd, pmode, dmode, iawmode, action, outMin, outMax, sampleTimeUs,
+                            getMicros, ticksPerSec);
+    }
+    constexpr QuickPIDConfig Modes(QuickPID::pMode pMode, QuickPID::dMode dMode, QuickPID::iAwMode iAwMode) const {
+      return QuickPIDConfig(dispKp, dispKi, dispKd, pMode, dMode, iAwMode, action, outMin, outMax, sampleTimeUs,
+                            getMicros, ticksPerSec);
+    }
+    constexpr QuickPIDConfig Direction(QuickPID::Action Action) const {
+      return QuickPIDConfig(dispKp, dispKi, dispKd, pmode, dmode, iawmode, Action, outMin, outMax, sampleTimeUs,
+                            getMicros, ticksPerSec);
+    }
+    constexpr QuickPIDConfig OutputLimits(float Min, float Max) const {
+      return (Min >= Max) ? *this :
+             QuickPIDConfig(dispKp, dispKi, dispKd, pmode, dmode, iawmode, action, Min, Max, sampleTimeUs,
+                            getMicros, ticksPerSec);
+    }
+    constexpr QuickPIDConfig SampleTimeUs(uint32_t NewSampleTimeUs) const {
+      return (NewSampleTimeUs == 0) ? *this :
+             QuickPIDConfig(dispKp, dispKi, dispKd, pmode, dmode, iawmode, action, outMin, outMax, NewSampleTimeUs,
+                            getMicros, ticksPerSec);
+    }
+    // The clock for automatic mode and its rate in ticks per second, as for QuickPID::SetClock().
+    constexpr QuickPIDConfig Clock(tGetTimeMicros getTicks, uint32_t TicksPerSec = 1000000) const {
+      return (TicksPerSec == 0) ? *this :
+             QuickPIDConfig(dispKp, dispKi, dispKd, pmode, dmode, iawmode, action, outMin, outMax, sampleTimeUs,
+                            getTicks, TicksPerSec);
+    }
+
+  private:
+
+    friend class QuickPID;
+
+    // Negative gains are ignored with the modes, as by SetTunings(). The scaling is the same as SetTunings()
+    // and SetSampleTicks(), so the results are bit for bit the same.
+    constexpr QuickPIDConfig(float Kp, float Ki, float Kd, QuickPID::pMode pMode, QuickPID::dMode dMode,
+                             QuickPID::iAwMode iAwMode, QuickPID::Action Action, float Min, float Max,
+                             uint32_t SampleTimeUs, tGetTimeMicros getTicks, uint32_t TicksPerSec)
+      : dispKp(Valid(Kp, Ki, Kd) ? Kp : 0), dispKi(Valid(Kp, Ki, Kd) ? Ki : 0), dispKd(Valid(Kp, Ki, Kd) ? Kd : 0),
+        kp(Valid(Kp, Ki, Kd) ? Kp : 0), ki(Valid(Kp, Ki, Kd) ? Ki * ((float)SampleTimeUs / 1000000) : 0),
+        kd(Valid(Kp, Ki, Kd) ? Kd / ((float)SampleTimeUs / 1000000) : 0),
+        outMin(Min), outMax(Max),
+        sampleTimeUs(SampleTimeUs), ticksPerSec(TicksPerSec),
+        sampleTicks(Ticks((uint64_t)SampleTimeUs * TicksPerSec / 1000000)), getMicros(getTicks),
+        action(Action),
+        pmode(Valid(Kp, Ki, Kd) ? pMode : QuickPID::pMode::pOnError),
+        dmode(Valid(Kp, Ki, Kd) ? dMode : QuickPID::dMode::dOnMeas),
+        iawmode(Valid(Kp, Ki, Kd) ? iAwMode : QuickPID::iAwMode::iAwCondition) {}
+
+    static constexpr bool Valid(float Kp, float Ki, float Kd) {
+      return Kp >= 0 && Ki >= 0 && Kd >= 0;
+    }
+    static constexpr uint32_t Ticks(uint64_t ticks) {
+      return (ticks > 0x7FFFFFFF) ? 0x7FFFFFFF : (ticks == 0) ? 1 : (uint32_t)ticks;
+    }
+
+    float dispKp, dispKi, dispKd;  // tunings as given
+    float kp, ki, kd;              // scaled for the sample time
+    float outMin, outMax;
+    uint32_t sampleTimeUs, ticksPerSec, sampleTicks;
+    tGetTimeMicros getMicros;
+    QuickPID::Action action;
+    QuickPID::pMode pmode;
+    QuickPID::dMode dmode;
+    QuickPID::iAwMode iawmode;
+
+}; // struct QuickPIDConfig
+
+// Defined here, since a constexpr constructor must be visible where it's used.
+constexpr QuickPID::QuickPID(float *Input, float *Output, float *Setpoint, const QuickPIDConfig &Config)
+  : dispKp(Config.dispKp), dispKi(Config.dispKi), dispKd(Config.dispKd),
+    kp(Config.kp), ki(Config.ki), kd(Config.kd),
+    myInput(Input), myOutput(Output), mySetpoint(Setpoint),
+    _getMicros(Config.getMicros), ticksPerSec(Config.ticksPerSec), sampleTicks(Config.sampleTicks),
+    action(Config.action), pmode(Config.pmode), dmode(Config.dmode), iawmode(Config.iawmode),
+    sampleTimeUs(Config.sampleTimeUs),
+    outMin(Config.outMin), outMax(Config.outMax) {}
+
+/* QuickPIDStep(...) ****************************************************************
+   Performs one PID calculation on the given state. This is the math shared by
+   QuickPID::Compute() and BasicQuickPID::Compute(). When the mode arguments are
+   compile-time constants, the compiler drops the unused branches and terms.
+   If dFilter is given, the derivative term is low-pass filtered with
+   coefficient dAlpha, and dFilter holds the filter state. If awActive is
+   given, it's set when anti-windup limits the integral. A feedForward value
+   is added to the output, and the integral sum is limited to the range the
+   output has left beside it. With iAwBackCalc, trackGain times the amount
+   by which the output is clamped is taken back out of the integral sum.
+   The integral sum may have a wider type S than T. If sumComp is given, the
+   integral is added with Kahan compensated summation and sumComp holds the
+   rounding error carried to the next step.
+ ***********************************************************************************/
+template <typename T, typename S>
+inline T QuickPIDStep(QuickPID::Action action, QuickPID::pMode pmode,
+                      QuickPID::dMode dmode, QuickPID::iAwMode iawmode,
+                      T input, T setpoint, T kp, T ki, T kd, T outMin, T outMax,
+                      S &outputSum, T &lastInput, T &lastError,
+                      T &error, T &pTerm, T &iTerm, T &dTerm,
+                      T *dFilter = NULL, T dAlpha = T(1), bool *awActive = NULL,
+                      T feedForward = T(0), T trackGain = T(1), T *sumComp = NULL) {
+
+  T dInput = input - lastInput;
+  if (action == QuickPID::Action::reverse) dInput = -dInput;
+
+  error = setpoint - input;
+  if (action == QuickPID::Action::reverse) error = -error;
+  T dError = error - lastError;
+
+  T peTerm = T(0);
+  T pmTerm = T(0);
+  if (pmode == QuickPID::pMode::pOnError) peTerm = kp * error;
+  else if (pmode == QuickPID::pMode::pOnMeas) pmTerm = kp * dInput;
+  else { //pOnErrorMeas
+    peTerm = (kp * error) * T(0.5f);
+    pmTerm = (kp * dInput) * T(0.5f);
+  }
+  pTerm = peTerm - pmTerm; // used by GetPterm()
+  iTerm = ki * error;
+  if (dmode == QuickPID::dMode::dOnError) dTerm = kd * dError;
+  else dTerm = -kd * dInput; // dOnMeas
+  if (dFilter != NULL) {
+    *dFilter += dAlpha * (dTerm - *dFilter);
+    dTerm = *dFilter;
+  }
+
+  //condition anti-windup (default)
+  if (iawmode == QuickPID::iAwMode::iAwCondition) {
+    bool aw = false;
+    T iTermOut = (peTerm - pmTerm) + ki * (iTerm + error);
+    if (iTermOut > outMax && dError > T(0)) aw = true;
+    else if (iTermOut < outMin && dError < T(0)) aw = true;
+    if (aw && ki != T(0)) {
+      iTerm = CONSTRAIN(iTermOut, -outMax, outMax);
+      if (awActive != NULL) *awActive = true;
+    }
+  }
+
+  // by default, compute output as per PID_v1
+  if (sumComp != NULL) {                                               // include integral amount
+    T y = iTerm - *sumComp;                                            // compensated
+    S t = outputSum + y;
+    *sumComp = (t - outputSum) - y;
+    outputSum = t;
+  } else outputSum += iTerm;
+  if (iawmode == QuickPID::iAwMode::iAwOff ||
+      iawmode == QuickPID::iAwMode::iAwBackCalc) outputSum -= pmTerm;  // include pmTerm (no clamp)
+  else {                                                               // include pmTerm and clamp
+    S sum = outputSum - pmTerm;
+    outputSum = CONSTRAIN(sum, S(outMin - feedForward), S(outMax - feedForward));
+    if (outputSum != sum) {
+      if (awActive != NULL) *awActive = true;
+      if (sumComp != NULL) *sumComp = T(0);
+    }
+  }
+
+  lastError = error;
+  lastInput = input;
+  T output = T(outputSum + peTerm + dTerm);                            // include dTerm
+  if (feedForward != T(0)) output += feedForward;                      // include feed-forward
+  T clamped = CONSTRAIN(output, outMin, outMax);                       // and clamp
+  if (iawmode == QuickPID::iAwMode::iAwBackCalc && clamped != output) {
+    outputSum += trackGain * (clamped - output);                       // back-calculation
+    if (awActive != NULL) *awActive = true;
+  }
+  return clamped;
+}
+
+#if defined(QUICKPID_HEADER_ONLY)
+#include "QuickPID.cpp"
+#endif
+
 #endif // QuickPID.h
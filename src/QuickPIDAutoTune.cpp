@@ -0,0 +1,142 @@
+/**********************************************************************************
+   QuickPIDAutoTune - non-blocking relay autotuner for QuickPID
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDAutoTune.h"
+
+/* Constructor ********************************************************************/
+QuickPIDAutoTune::QuickPIDAutoTune(float* Input, float* Output, float* Setpoint) {
+  myInput = Input;
+  myOutput = Output;
+  mySetpoint = Setpoint;
+}
+
+/* Configure(...)******************************************************************
+   The relay amplitude Step should move the process well beyond the hysteresis
+   band. Hysteresis should be a little more than the noise on the input.
+ **********************************************************************************/
+void QuickPIDAutoTune::Configure(float Bias, float Step, float Hysteresis, uint8_t Cycles,
+                                 uint32_t SampleTimeUs, QuickPID::Action Action, uint32_t MaxSamples) {
+  if (Step <= 0 || Hysteresis < 0 || Cycles == 0 || SampleTimeUs == 0) return;
+  bias = Bias;
+  step = Step;
+  hysteresis = Hysteresis;
+  cycles = Cycles;
+  sampleTimeUs = SampleTimeUs;
+  action = Action;
+  maxSamples = MaxSamples;
+}
+
+void QuickPIDAutoTune::Start() {
+  status = Status::running;
+  relayHigh = true;
+  measured = 0;
+  switches = 0;
+  samples = 0;
+  lastRise = 0;
+  float error = *mySetpoint - *myInput;
+  peakMax = peakMin = (action == QuickPID::Action::reverse) ? -error : error;
+  sumAmplitude = sumPeriod = 0;
+  *myOutput = bias + step;
+}
+
+/* Run() ***************************************************************************
+   The relay switches low when the error passes -hysteresis and high when it
+   passes +hysteresis. The peaks are tracked on the error, which has the sign
+   of the action applied, so they fall in the same half cycles for direct and
+   reverse action: the error minimum occurs while the relay is low and the
+   maximum while it is high, so each half cycle tracks one extreme. At every
+   low to high switch a full cycle has ended, and its amplitude and period
+   are added to the sums.
+ **********************************************************************************/
+QuickPIDAutoTune::Status QuickPIDAutoTune::Run() {
+  if (status != Status::running) return status;
+  float input = *myInput;
+  float error = *mySetpoint - input;
+  if (action == QuickPID::Action::reverse) error = -error;
+  samples++;
+
+  if (relayHigh) {
+    if (error > peakMax) peakMax = error;
+    if (error < -hysteresis) {                // high to low
+      relayHigh = false;
+      peakMin = error;
+      if (switches < 3) switches++;
+    }
+  } else {
+    if (error < peakMin) peakMin = error;
+    if (error > hysteresis) {                 // low to high, one full cycle
+      relayHigh = true;
+      if (switches < 3) switches++;
+      if (switches > 2) {                     // discard the first cycle, it starts off the limit cycle
+        sumAmplitude += (peakMax - peakMin) * 0.5f;
+        sumPeriod += (float)(samples - lastRise);
+        measured++;
+      }
+      lastRise = samples;
+      peakMax = error;
+    }
+  }
+  *myOutput = relayHigh ? bias + step : bias - step;
+
+  if (measured >= cycles) {
+    float a = sumAmplitude / measured;
+    ku = (a > 0) ? (4.0f * step) / (3.14159265f * a) : 0;  // relay describing function
+    pu = (sumPeriod / measured) * ((float)sampleTimeUs / 1000000);
+    *myOutput = bias;
+    status = Status::done;
+  } else if (samples >= maxSamples) {
+    *myOutput = bias;
+    status = Status::timeout;
+  }
+  return status;
+}
+
+/* Tuning rules ********************************************************************
+   Kp, Ti and Td from Ku and Pu, returned as the parallel gains Kp, Ki = Kp / Ti
+   and Kd = Kp * Td that SetTunings() expects.
+ **********************************************************************************/
+float QuickPIDAutoTune::GetKp(Rule rule) {
+  switch (rule) {
+    case Rule::zieglerNicholsPI: return 0.45f * ku;
+    case Rule::tyreusLuybenPID: return ku / 2.2f;
+    case Rule::noOvershootPID: return 0.2f * ku;
+    default: return 0.6f * ku; // zieglerNicholsPID
+  }
+}
+
+float QuickPIDAutoTune::GetKi(Rule rule) {
+  if (pu <= 0) return 0;
+  switch (rule) {
+    case Rule::zieglerNicholsPI: return GetKp(rule) / (pu / 1.2f);
+    case Rule::tyreusLuybenPID: return GetKp(rule) / (2.2f * pu);
+    default: return GetKp(rule) / (0.5f * pu); // zieglerNicholsPID, noOvershootPID
+  }
+}
+
+float QuickPIDAutoTune::GetKd(Rule rule) {
+  switch (rule) {
+    case Rule::zieglerNicholsPI: return 0;
+    case Rule::tyreusLuybenPID: return GetKp(rule) * (pu / 6.3f);
+    case Rule::noOvershootPID: return GetKp(rule) * (pu / 3.0f);
+    default: return GetKp(rule) * (pu / 8.0f); // zieglerNicholsPID
+  }
+}
+
+bool QuickPIDAutoTune::SetTunings(QuickPID &pid, Rule rule) {
+  if (status != Status::done) return false;
+  pid.SetTunings(GetKp(rule), GetKi(rule), GetKd(rule));
+  return true;
+}
+
+/* Status Functions************************************************************/
+QuickPIDAutoTune::Status QuickPIDAutoTune::GetStatus() {
+  return status;
+}
+float QuickPIDAutoTune::GetKu() {
+  return ku;
+}
+float QuickPIDAutoTune::GetPu() {
+  return pu;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef QuickPIDAutoTune_h
+#define QuickPIDAutoTune_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDAutoTune is a non-blocking relay autotuner (Astrom-Hagglund method).
+   It drives Output between Bias + Step and Bias - Step around the Setpoint,
+   with a hysteresis band against input noise, until the process settles into
+   a limit cycle. From the cycle amplitude and period it identifies the
+   ultimate gain Ku and period Pu, then computes tunings with a selectable
+   rule. Peaks and periods are accumulated as they occur, so no buffer of the
+   response is kept.
+
+   Run() must be called once per sample period, with the same cadence as a
+   PID in timer mode. It returns running until the test completes.
+ **********************************************************************************/
+class QuickPIDAutoTune {
+
+  public:
+
+    enum class Status : uint8_t {idle, running, done, timeout};
+    enum class Rule : uint8_t {zieglerNicholsPI, zieglerNicholsPID, tyreusLuybenPID, noOvershootPID};
+
+    // Constructor. Links the tuner to the same Input, Output and Setpoint as the PID.
+    QuickPIDAutoTune(float *Input, float *Output, float *Setpoint);
+
+    // Sets the relay Output Bias and Step, the Input hysteresis band, the number of limit cycles to average,
+    // the sample period at which Run() is called, the controller action and the test timeout in samples.
+    void Configure(float Bias, float Step, float Hysteresis, uint8_t Cycles, uint32_t SampleTimeUs,
+                   QuickPID::Action Action = QuickPID::Action::direct, uint32_t MaxSamples = 100000);
+
+    // Starts (or restarts) the relay test.
+    void Start();
+
+    // Performs one relay test step and drives Output. Returns the test status.
+    Status Run();
+
+    // Computes tunings from the identified Ku and Pu with the given rule and applies them with
+    // SetTunings(). Returns false if the test isn't done.
+    bool SetTunings(QuickPID &pid, Rule rule = Rule::zieglerNicholsPID);
+
+    // Query functions.
+    Status GetStatus();
+    float GetKu();      // ultimate gain
+    float GetPu();      // ultimate period in seconds
+    float GetKp(Rule rule);
+    float GetKi(Rule rule);
+    float GetKd(Rule rule);
+
+  private:
+
+    float *myInput;
+    float *myOutput;
+    float *mySetpoint;
+
+    float bias = 0, step = 0, hysteresis = 0;
+    uint8_t cycles = 4;
+    uint32_t sampleTimeUs = 100000;
+    uint32_t maxSamples = 100000;
+    QuickPID::Action action = QuickPID::Action::direct;
+
+    Status status = Status::idle;
+    bool relayHigh;
+    uint8_t measured;           // limit cycles measured so far
+    uint8_t switches;           // relay switches so far (up to 3), the first cycle is discarded
+    uint32_t samples;           // samples since Start()
+    uint32_t lastRise;          // sample count at the previous low to high switch
+    float peakMax, peakMin;     // error extremes of the current half cycle
+    float sumAmplitude, sumPeriod;
+    float ku = 0, pu = 0;
+
+}; // class QuickPIDAutoTune
+#endif // QuickPIDAutoTune.h
@@ -0,0 +1,265 @@
+#pragma once
+#ifndef QuickPIDBank_h
+#define QuickPIDBank_h
+
+#include "QuickPID.h"
+
+#if defined(__SSE2__) && !defined(QUICKPID_NO_SIMD)
+#include <emmintrin.h>
+#define QUICKPID_BANK_SSE2
+#endif
+
+/**********************************************************************************
+   QuickPIDBank runs N independent PID loops that share the same controller
+   action, proportional, derivative and anti-windup modes. Channel state is
+   kept as contiguous arrays (structure-of-arrays) and ComputeAll() steps every
+   channel that is due in a single pass with one clock read. Each channel gives
+   the same result as a separate QuickPID::Compute() with the same settings.
+
+   Channel I/O is by value: write input[ch] and setpoint[ch], read output[ch].
+ **********************************************************************************/
+template <uint8_t N>
+class QuickPIDBank {
+
+  public:
+
+    typedef QuickPID::Control Control;
+    typedef QuickPID::Action Action;
+    typedef QuickPID::pMode pMode;
+    typedef QuickPID::dMode dMode;
+    typedef QuickPID::iAwMode iAwMode;
+
+    float input[N];     // channel inputs, written by the user
+    float setpoint[N];  // channel setpoints, written by the user
+    float output[N];    // channel outputs, written by ComputeAll()
+
+    // Constructor. Sets the modes shared by all channels. Channel gains default to 0,
+    // limits to 0-255 and sample time to 100000 µs.
+    QuickPIDBank(pMode pMode = pMode::pOnError, dMode dMode = dMode::dOnMeas,
+                 iAwMode iAwMode = iAwMode::iAwCondition, Action Action = Action::direct,
+                 tGetTimeMicros getMicros = QUICKPID_DEFAULT_CLOCK) {
+      pmode = pMode; dmode = dMode; iawmode = iAwMode; action = Action;
+      _getMicros = getMicros;
+      for (uint8_t i = 0; i < N; i++) {
+        input[i] = setpoint[i] = output[i] = 0;
+        kp[i] = ki[i] = kd[i] = 0;
+        outputSum[i] = lastInput[i] = lastError[i] = 0;
+        outMin[i] = 0;
+        outMax[i] = 255;  // same default as Arduino PWM limit
+        sampleTimeUs[i] = 100000;
+        lastTime[i] = 0;
+      }
+    }
+
+    // Sets all channels to manual (0), automatic (1) or timer (2). The transition from manual
+    // initializes every channel for a bumpless transfer, as QuickPID::SetMode() does.
+    void SetMode(Control Mode, tGetTimeMicros getMicros = NULL) {
+      if (mode == Control::manual && Mode != Control::manual) {
+        for (uint8_t i = 0; i < N; i++) {
+          outputSum[i] = CONSTRAIN(output[i], outMin[i], outMax[i]);
+          lastInput[i] = input[i];
+          lastError[i] = 0;
+        }
+      }
+      mode = Mode;
+      if (getMicros != NULL) _getMicros = getMicros;
+      if (_getMicros != NULL) {
+        uint32_t now = _getMicros();
+        for (uint8_t i = 0; i < N; i++) lastTime[i] = now - sampleTimeUs[i];
+      }
+    }
+
+    // Computes every channel that is due (all channels in timer mode) and returns
+    // the number of channels computed. The channel math is branch-free: channels that
+    // are not due, or that don't need anti-windup, are masked instead of skipped, so
+    // the loop vectorizes. On x86 hosts with SSE2, 4 channels are computed per step.
+    uint8_t ComputeAll() {
+      if (mode == Control::manual) return 0;
+      bool poll = (mode == Control::automatic);
+      if (poll && _getMicros == NULL) return 0;
+      uint32_t now = poll ? (uint32_t)_getMicros() : 0;
+      uint8_t i = 0, computed = 0;
+#if defined(QUICKPID_BANK_SSE2)
+      computed = ComputeSse2(i, now, poll);
+#endif
+      for (; i < N; i++) {
+        bool due = !poll || (uint32_t)(now - lastTime[i]) >= sampleTimeUs[i];
+        computed += ComputeLane(i, due, now);
+      }
+      return computed;
+    }
+
+    // Sets the tunings of one channel, pre-scaled by its sample time.
+    void SetTunings(uint8_t ch, float Kp, float Ki, float Kd) {
+      if (ch >= N || Kp < 0 || Ki < 0 || Kd < 0) return;
+      float SampleTimeSec = (float)sampleTimeUs[ch] / 1000000;
+      kp[ch] = Kp;
+      ki[ch] = Ki * SampleTimeSec;
+      kd[ch] = Kd / SampleTimeSec;
+    }
+
+    // Sets the sample time of one channel in microseconds.
+    void SetSampleTimeUs(uint8_t ch, uint32_t NewSampleTimeUs) {
+      if (ch >= N || NewSampleTimeUs == 0) return;
+      float ratio = (float)NewSampleTimeUs / (float)sampleTimeUs[ch];
+      ki[ch] *= ratio;
+      kd[ch] /= ratio;
+      sampleTimeUs[ch] = NewSampleTimeUs;
+    }
+
+    // Sets and clamps the output range of one channel.
+    void SetOutputLimits(uint8_t ch, float Min, float Max) {
+      if (ch >= N || Min >= Max) return;
+      outMin[ch] = Min;
+      outMax[ch] = Max;
+      if (mode != Control::manual) {
+        output[ch] = CONSTRAIN(output[ch], Min, Max);
+        outputSum[ch] = CONSTRAIN(outputSum[ch], Min, Max);
+      }
+    }
+
+    // Shared mode setters, same as the QuickPID functions of the same name.
+    void SetControllerDirection(Action Action) { action = Action; }
+    void SetProportionalMode(pMode pMode) { pmode = pMode; }
+    void SetDerivativeMode(dMode dMode) { dmode = dMode; }
+    void SetAntiWindupMode(iAwMode iAwMode) { iawmode = iAwMode; }
+
+    // Query functions. Channel gains are recomputed from the pre-scaled gains and sample time.
+    float GetKp(uint8_t ch) { return kp[ch]; }
+    float GetKi(uint8_t ch) { return ki[ch] * 1000000 / (float)sampleTimeUs[ch]; }
+    float GetKd(uint8_t ch) { return kd[ch] * (float)sampleTimeUs[ch] / 1000000; }
+    uint8_t GetMode() { return static_cast<uint8_t>(mode); }
+    uint8_t GetDirection() { return static_cast<uint8_t>(action); }
+    uint8_t GetPmode() { return static_cast<uint8_t>(pmode); }
+    uint8_t GetDmode() { return static_cast<uint8_t>(dmode); }
+    uint8_t GetAwMode() { return static_cast<uint8_t>(iawmode); }
+
+  private:
+
+    // One channel of ComputeAll(), the same math as QuickPIDStep() written with selects.
+    // Bank-wide mode tests are loop invariant and hoisted by the compiler.
+    bool ComputeLane(uint8_t i, bool due, uint32_t now) {
+      float sign = (action == Action::reverse) ? -1.0f : 1.0f;
+      float peScale = (pmode == pMode::pOnMeas) ? 0.0f : (pmode == pMode::pOnError) ? 1.0f : 0.5f;
+      float pmScale = (pmode == pMode::pOnError) ? 0.0f : (pmode == pMode::pOnMeas) ? 1.0f : 0.5f;
+      float in = input[i];
+      float dInput = (in - lastInput[i]) * sign;
+      float error = (setpoint[i] - in) * sign;
+      float dError = error - lastError[i];
+      float peTerm = (kp[i] * error) * peScale;
+      float pmTerm = (kp[i] * dInput) * pmScale;
+      float iTerm = ki[i] * error;
+      float dTerm = kd[i] * ((dmode == dMode::dOnError) ? dError : -dInput);
+      if (iawmode == iAwMode::iAwCondition) {
+        float iTermOut = (peTerm - pmTerm) + ki[i] * (iTerm + error);
+        bool aw = ((iTermOut > outMax[i]) & (dError > 0)) | ((iTermOut < outMin[i]) & (dError < 0));
+        aw = aw & (ki[i] != 0);
+        iTerm = aw ? CONSTRAIN(iTermOut, -outMax[i], outMax[i]) : iTerm;
+      }
+      float sum = outputSum[i] + iTerm;
+      bool noClamp = (iawmode == iAwMode::iAwOff) | (iawmode == iAwMode::iAwBackCalc);
+      sum = noClamp ? sum - pmTerm : CONSTRAIN(sum - pmTerm, outMin[i], outMax[i]);
+      float unclamped = sum + peTerm + dTerm;
+      float out = CONSTRAIN(unclamped, outMin[i], outMax[i]);
+      if (iawmode == iAwMode::iAwBackCalc) sum += out - unclamped;
+      outputSum[i] = due ? sum : outputSum[i];
+      output[i] = due ? out : output[i];
+      lastError[i] = due ? error : lastError[i];
+      lastInput[i] = due ? in : lastInput[i];
+      lastTime[i] = due ? now : lastTime[i];
+      return due;
+    }
+
+#if defined(QUICKPID_BANK_SSE2)
+    // ComputeLane() for 4 channels at a time. Returns the number of channels computed
+    // and advances i past the last complete group of 4.
+    uint8_t ComputeSse2(uint8_t &i, uint32_t now, bool poll) {
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 ones = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      const __m128 sign = _mm_set1_ps((action == Action::reverse) ? -1.0f : 1.0f);
+      const __m128 peScale = _mm_set1_ps((pmode == pMode::pOnMeas) ? 0.0f : (pmode == pMode::pOnError) ? 1.0f : 0.5f);
+      const __m128 pmScale = _mm_set1_ps((pmode == pMode::pOnError) ? 0.0f : (pmode == pMode::pOnMeas) ? 1.0f : 0.5f);
+      const __m128i vnow = _mm_set1_epi32((int32_t)now);
+      const __m128i bias = _mm_set1_epi32((int32_t)0x80000000u);  // for unsigned compare
+      uint8_t computed = 0;
+      for (; i + 4 <= N; i += 4) {
+        __m128 due = ones;
+        __m128i lt = _mm_loadu_si128((const __m128i *)&lastTime[i]);
+        if (poll) {
+          __m128i elapsed = _mm_xor_si128(_mm_sub_epi32(vnow, lt), bias);
+          __m128i period = _mm_xor_si128(_mm_loadu_si128((const __m128i *)&sampleTimeUs[i]), bias);
+          due = _mm_castsi128_ps(_mm_cmplt_epi32(elapsed, period));
+          due = _mm_andnot_ps(due, ones);
+        }
+        int dueBits = _mm_movemask_ps(due);
+        if (dueBits == 0) continue;
+        __m128 in = _mm_loadu_ps(&input[i]);
+        __m128 lin = _mm_loadu_ps(&lastInput[i]);
+        __m128 lerr = _mm_loadu_ps(&lastError[i]);
+        __m128 osum = _mm_loadu_ps(&outputSum[i]);
+        __m128 out = _mm_loadu_ps(&output[i]);
+        __m128 vkp = _mm_loadu_ps(&kp[i]);
+        __m128 vki = _mm_loadu_ps(&ki[i]);
+        __m128 vkd = _mm_loadu_ps(&kd[i]);
+        __m128 mn = _mm_loadu_ps(&outMin[i]);
+        __m128 mx = _mm_loadu_ps(&outMax[i]);
+
+        __m128 dInput = _mm_mul_ps(_mm_sub_ps(in, lin), sign);
+        __m128 error = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&setpoint[i]), in), sign);
+        __m128 dError = _mm_sub_ps(error, lerr);
+        __m128 peTerm = _mm_mul_ps(_mm_mul_ps(vkp, error), peScale);
+        __m128 pmTerm = _mm_mul_ps(_mm_mul_ps(vkp, dInput), pmScale);
+        __m128 iTerm = _mm_mul_ps(vki, error);
+        __m128 dTerm = _mm_mul_ps(vkd, (dmode == dMode::dOnError) ? dError : _mm_sub_ps(zero, dInput));
+        if (iawmode == iAwMode::iAwCondition) {
+          __m128 iTermOut = _mm_add_ps(_mm_sub_ps(peTerm, pmTerm), _mm_mul_ps(vki, _mm_add_ps(iTerm, error)));
+          __m128 aw = _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps(iTermOut, mx), _mm_cmpgt_ps(dError, zero)),
+                                _mm_and_ps(_mm_cmplt_ps(iTermOut, mn), _mm_cmplt_ps(dError, zero)));
+          aw = _mm_andnot_ps(_mm_cmpeq_ps(vki, zero), aw);
+          __m128 clamped = _mm_min_ps(_mm_max_ps(iTermOut, _mm_sub_ps(zero, mx)), mx);
+          iTerm = Blend(aw, clamped, iTerm);
+        }
+        __m128 sum = _mm_sub_ps(_mm_add_ps(osum, iTerm), pmTerm);
+        if (iawmode != iAwMode::iAwOff && iawmode != iAwMode::iAwBackCalc) sum = _mm_min_ps(_mm_max_ps(sum, mn), mx);
+        __m128 unclamped = _mm_add_ps(_mm_add_ps(sum, peTerm), dTerm);
+        __m128 result = _mm_min_ps(_mm_max_ps(unclamped, mn), mx);
+        if (iawmode == iAwMode::iAwBackCalc) sum = _mm_add_ps(sum, _mm_sub_ps(result, unclamped));
+
+        _mm_storeu_ps(&outputSum[i], Blend(due, sum, osum));
+        _mm_storeu_ps(&output[i], Blend(due, result, out));
+        _mm_storeu_ps(&lastError[i], Blend(due, error, lerr));
+        _mm_storeu_ps(&lastInput[i], Blend(due, in, lin));
+        _mm_storeu_si128((__m128i *)&lastTime[i],
+                         _mm_castps_si128(Blend(due, _mm_castsi128_ps(vnow), _mm_castsi128_ps(lt))));
+        computed += (dueBits & 1) + ((dueBits >> 1) & 1) + ((dueBits >> 2) & 1) + (dueBits >> 3);
+      }
+      return computed;
+    }
+
+    static __m128 Blend(__m128 mask, __m128 a, __m128 b) {
+      return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+#endif
+
+
+    float kp[N];                // pre-scaled channel gains
+    float ki[N];
+    float kd[N];
+    float outputSum[N];
+    float lastInput[N];
+    float lastError[N];
+    float outMin[N];
+    float outMax[N];
+    uint32_t sampleTimeUs[N];
+    uint32_t lastTime[N];
+
+    tGetTimeMicros _getMicros;
+
+    Control mode = Control::manual;
+    Action action = Action::direct;
+    pMode pmode = pMode::pOnError;
+    dMode dmode = dMode::dOnMeas;
+    iAwMode iawmode = iAwMode::iAwCondition;
+
+}; // class QuickPIDBank
+#endif // QuickPIDBank.h
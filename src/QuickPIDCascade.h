@@ -0,0 +1,108 @@
+#pragma once
+#ifndef QuickPIDCascade_h
+#define QuickPIDCascade_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDCascade chains N QuickPID stages, outermost first (for example
+   position, velocity, current). Each stage's output is passed by value as the
+   setpoint of the next stage, so the intermediate values never go through the
+   stages' Input/Output/Setpoint pointers.
+
+   Compute() is called once per scheduler tick. Stage i runs every Dividers[i]
+   ticks, so inner stages run at integer multiples of the outer rate, in
+   lockstep. Each stage's sample time is set to Dividers[i] * TickUs.
+
+   When an inner stage saturates at its output limit, the stage outside it
+   stops integrating in the direction that would drive the inner setpoint
+   further into saturation (anti-windup propagated outward).
+
+   The cascade computes the stages itself, so their timing mode doesn't
+   matter, but a stage in manual mode is skipped and holds its output.
+
+   QuickPID *stages[3] = {&posPID, &velPID, &curPID};
+   const uint16_t dividers[3] = {10, 2, 1};
+   QuickPIDCascade<3> cascade(stages, dividers, 100);  // 100 µs tick
+   for (QuickPID *s : stages) s->SetMode(QuickPID::Control::timer);
+   cascade.Initialize(inputs, Output);
+ **********************************************************************************/
+template <uint8_t N>
+class QuickPIDCascade {
+
+  public:
+
+    // Links the stages, outermost first, and sets their sample times from the tick period.
+    QuickPIDCascade(QuickPID *const Stages[N], const uint16_t Dividers[N], uint32_t TickUs) {
+      for (uint8_t i = 0; i < N; i++) {
+        stage[i] = Stages[i];
+        divider[i] = (Dividers[i] > 0) ? Dividers[i] : 1;
+        stage[i]->SetSampleTimeUs(divider[i] * TickUs);
+      }
+      Initialize(NULL, 0);
+    }
+
+    // Bumpless start from the current measurements (one per stage, outermost first) and the current
+    // output of the innermost stage. Each setpoint starts at that stage's input. Stages in manual mode
+    // keep their state, and hold this output until they are switched back and Initialize() is called again.
+    void Initialize(const float *Inputs, float Output) {
+      for (uint8_t i = 0; i < N; i++) {
+        QuickPID &s = *stage[i];
+        float in = (Inputs != NULL) ? Inputs[i] : 0;
+        float out = Output;
+        if (i + 1 < N) out = (Inputs != NULL) ? Inputs[i + 1] : 0;
+        if (s.mode != QuickPID::Control::manual) {
+          s.Initialize(in, out, in);
+          out = s.sentOutput;  // within the stage's limits
+        }
+        stageOutput[i] = out;
+        count[i] = divider[i] - 1;  // all stages run on the first tick
+        saturated[i] = 0;
+      }
+    }
+
+    // Runs one scheduler tick with the outer Setpoint and the stage measurements (one per stage,
+    // outermost first). Returns the output of the innermost stage.
+    float Compute(float Setpoint, const float *Inputs) {
+      float sp = Setpoint;
+      for (uint8_t i = 0; i < N; i++) {
+        if (++count[i] >= divider[i]) {
+          count[i] = 0;
+          QuickPID &s = *stage[i];
+          if (s.mode == QuickPID::Control::manual) {  // holds its output
+            sp = stageOutput[i];
+            continue;
+          }
+          float stepKi = s.ki;
+          if (i + 1 < N && saturated[i + 1] != 0) {
+            // anti-windup: don't integrate further into the inner stage's saturation
+            int8_t dir = (stage[i + 1]->action == QuickPID::Action::reverse) ? -saturated[i + 1] : saturated[i + 1];
+            float error = sp - Inputs[i];
+            if (s.action == QuickPID::Action::reverse) error = -error;
+            if ((dir > 0 && error > 0) || (dir < 0 && error < 0)) stepKi = 0;
+          }
+          float out = s.Step(Inputs[i], sp, stepKi, s.kd);
+          stageOutput[i] = out;
+          saturated[i] = (out >= s.outMax) ? 1 : (out <= s.outMin) ? -1 : 0;
+        }
+        sp = stageOutput[i];
+      }
+      return sp;
+    }
+
+    // Returns the latest output of stage i, which is the setpoint of stage i + 1.
+    float GetOutput(uint8_t i) { return stageOutput[i]; }
+
+    // Returns 1 or -1 if stage i is saturated at its upper or lower output limit, otherwise 0.
+    int8_t GetSaturation(uint8_t i) { return saturated[i]; }
+
+  private:
+
+    QuickPID *stage[N];
+    uint16_t divider[N];
+    uint16_t count[N];
+    float stageOutput[N];
+    int8_t saturated[N];
+
+}; // class QuickPIDCascade
+#endif // QuickPIDCascade.h
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef QuickPIDClock_h
+#define QuickPIDClock_h
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#endif
+#if defined(ESP_PLATFORM)
+#include "esp_timer.h"
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#endif
+
+/**********************************************************************************
+   Time sources for automatic mode. A clock is any function returning a free
+   running tick count that wraps over the full 32 bits (unsigned subtraction of
+   two readings then gives the elapsed ticks, across wrap). Pass the function
+   and its rate to QuickPID::SetClock(), or just the function to SetMode() for
+   a microsecond clock. The sample time must be shorter than 2^31 ticks.
+
+   micros()                    Arduino, 1000000 ticks/s (default on Arduino)
+   QuickPIDClock::cycleCount   Cortex-M3/M4/M7 DWT CYCCNT, CPU clock ticks/s,
+                               call QuickPIDClock::EnableCycleCounter() first
+   QuickPIDClock::espTimer     ESP-IDF esp_timer_get_time(), 1000000 ticks/s
+   QuickPIDClock::cycleCount   x86 hosts, the time stamp counter (rdtsc)
+   user function               e.g. a hardware timer count, its own tick rate
+ **********************************************************************************/
+
+typedef unsigned long (*tGetTimeMicros)(void);
+
+#if defined(ARDUINO)
+#define QUICKPID_DEFAULT_CLOCK micros
+#else
+#define QUICKPID_DEFAULT_CLOCK NULL
+#endif
+
+struct QuickPIDClock {
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+  // Starts the DWT cycle counter. Reading it is a single register load.
+  static void EnableCycleCounter() {
+    *(volatile uint32_t *)0xE000EDFC |= (1UL << 24);  // CoreDebug DEMCR TRCENA
+#if defined(__ARM_ARCH_7EM__)
+    *(volatile uint32_t *)0xE0001FB0 = 0xC5ACCE55;    // DWT LAR unlock (needed on Cortex-M7)
+#endif
+    *(volatile uint32_t *)0xE0001004 = 0;             // DWT CYCCNT
+    *(volatile uint32_t *)0xE0001000 |= 1UL;          // DWT CTRL CYCCNTENA
+  }
+
+  static unsigned long cycleCount() {
+    return *(volatile uint32_t *)0xE0001004;
+  }
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+  // The time stamp counter, truncated so that it wraps over 32 bits. Its rate is the nominal
+  // CPU clock on current processors, which is what benchmarks want.
+  static unsigned long cycleCount() {
+    return (uint32_t)__rdtsc();
+  }
+#endif
+
+#if defined(ESP_PLATFORM)
+  // The 64-bit microsecond timer, truncated so that it wraps over 32 bits.
+  static unsigned long espTimer() {
+    return (uint32_t)esp_timer_get_time();
+  }
+#endif
+
+};
+#endif // QuickPIDClock.h
@@ -0,0 +1,145 @@
+/**********************************************************************************
+   QuickPIDFixed - Q16.16 fixed-point variant of the QuickPID Library
+   Same modes and math as QuickPID. Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDFixed.h"
+
+/* Constructor ********************************************************************/
+QuickPIDFixed::QuickPIDFixed(qfix16* Input, qfix16* Output, qfix16* Setpoint,
+                             float Kp, float Ki, float Kd,
+                             pMode pMode, dMode dMode, iAwMode iAwMode,
+                             Action Action, tGetTimeMicros getMicros) {
+  myOutput = Output;
+  myInput = Input;
+  mySetpoint = Setpoint;
+  _getMicros = getMicros;
+
+  SetOutputLimits(0, 255);  // same default as Arduino PWM limit
+  SetControllerDirection(Action);
+  SetTunings(Kp, Ki, Kd, pMode, dMode, iAwMode);
+}
+
+/* Compute() ***********************************************************************
+   Same as QuickPID::Compute(), using saturating Q16.16 arithmetic.
+ **********************************************************************************/
+bool QuickPIDFixed::Compute() {
+  if (mode == Control::manual) return false;
+  uint32_t now = lastTime;
+  if (mode == Control::automatic) {
+    if (_getMicros == NULL) return false;
+    now = _getMicros();
+    if ((uint32_t)(now - lastTime) < sampleTimeUs) return false;
+  }
+  *myOutput = QuickPIDStep(action, pmode, dmode, iawmode, *myInput, *mySetpoint,
+                           kp, ki, kd, outMin, outMax, outputSum, lastInput, lastError,
+                           error, pTerm, iTerm, dTerm);
+  lastTime = now;
+  return true;
+}
+
+/* SetTunings(....)************************************************************
+  Pre-scales the tunings by the sample time and converts them to fixed-point.
+******************************************************************************/
+void QuickPIDFixed::SetTunings(float Kp, float Ki, float Kd,
+                               pMode pMode, dMode dMode, iAwMode iAwMode) {
+  if (Kp < 0 || Ki < 0 || Kd < 0) return;
+  pmode = pMode; dmode = dMode; iawmode = iAwMode;
+  dispKp = Kp; dispKi = Ki; dispKd = Kd;
+  float SampleTimeSec = (float)sampleTimeUs / 1000000;
+  kp = qfix16(Kp);
+  ki = qfix16(Ki * SampleTimeSec);
+  kd = qfix16(Kd / SampleTimeSec);
+}
+
+void QuickPIDFixed::SetTunings(float Kp, float Ki, float Kd) {
+  SetTunings(Kp, Ki, Kd, pmode, dmode, iawmode);
+}
+
+/* SetSampleTime(.)***********************************************************
+  Re-scales the fixed-point gains from the display gains, so that repeated
+  changes don't accumulate rounding error.
+******************************************************************************/
+void QuickPIDFixed::SetSampleTimeUs(uint32_t NewSampleTimeUs) {
+  if (NewSampleTimeUs > 0) {
+    sampleTimeUs = NewSampleTimeUs;
+    SetTunings(dispKp, dispKi, dispKd);
+  }
+}
+
+void QuickPIDFixed::SetOutputLimits(qfix16 Min, qfix16 Max) {
+  if (Min >= Max) return;
+  outMin = Min;
+  outMax = Max;
+
+  if (mode != Control::manual) {
+    *myOutput = CONSTRAIN(*myOutput, outMin, outMax);
+    outputSum = CONSTRAIN(outputSum, outMin, outMax);
+  }
+}
+
+void QuickPIDFixed::SetMode(Control Mode, tGetTimeMicros getMicros) {
+  if (mode == Control::manual && Mode != Control::manual) { // just went from manual to automatic or timer
+    Initialize();
+  }
+  mode = Mode;
+  if (getMicros != NULL) _getMicros = getMicros;
+  if (_getMicros != NULL) lastTime = _getMicros() - sampleTimeUs;
+}
+
+void QuickPIDFixed::Initialize() {
+  outputSum = CONSTRAIN(*myOutput, outMin, outMax);
+  lastInput = *myInput;
+  lastError = qfix16();
+}
+
+void QuickPIDFixed::SetControllerDirection(Action Action) {
+  action = Action;
+}
+
+void QuickPIDFixed::SetProportionalMode(pMode pMode) {
+  pmode = pMode;
+}
+
+void QuickPIDFixed::SetDerivativeMode(dMode dMode) {
+  dmode = dMode;
+}
+
+void QuickPIDFixed::SetAntiWindupMode(iAwMode iAwMode) {
+  iawmode = iAwMode;
+}
+
+/* Status Functions************************************************************/
+float QuickPIDFixed::GetKp() {
+  return dispKp;
+}
+float QuickPIDFixed::GetKi() {
+  return dispKi;
+}
+float QuickPIDFixed::GetKd() {
+  return dispKd;
+}
+qfix16 QuickPIDFixed::GetPterm() {
+  return pTerm;
+}
+qfix16 QuickPIDFixed::GetIterm() {
+  return iTerm;
+}
+qfix16 QuickPIDFixed::GetDterm() {
+  return dTerm;
+}
+uint8_t QuickPIDFixed::GetMode() {
+  return static_cast<uint8_t>(mode);
+}
+uint8_t QuickPIDFixed::GetDirection() {
+  return static_cast<uint8_t>(action);
+}
+uint8_t QuickPIDFixed::GetPmode() {
+  return static_cast<uint8_t>(pmode);
+}
+uint8_t QuickPIDFixed::GetDmode() {
+  return static_cast<uint8_t>(dmode);
+}
+uint8_t QuickPIDFixed::GetAwMode() {
+  return static_cast<uint8_t>(iawmode);
+}
@@ -0,0 +1,164 @@
+#pragma once
+#ifndef QuickPIDFixed_h
+#define QuickPIDFixed_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   qfix16 is a signed Q16.16 fixed-point number with saturating arithmetic.
+   Range is -32768 to +32767.99998 with a resolution of 1/65536. Values that
+   overflow are clamped to the range limits instead of wrapping.
+ **********************************************************************************/
+struct qfix16 {
+
+  static const int32_t qMax = 0x7FFFFFFF;
+  static const int32_t qMin = -0x7FFFFFFF - 1;
+
+  int32_t raw;
+
+  qfix16() : raw(0) {}
+  qfix16(int v) : raw(v > 32767 ? qMax : v < -32768 ? qMin : (int32_t)v * 65536) {}
+  constexpr qfix16(float v) : raw(v >= 32768.0f ? qMax : v <= -32768.0f ? qMin :
+                                  (int32_t)(v * 65536.0f + (v < 0 ? -0.5f : 0.5f))) {}
+  constexpr qfix16(double v) : qfix16((float)v) {}  // so unsuffixed literals such as 1.5 aren't ambiguous
+
+  static qfix16 fromRaw(int32_t r) { qfix16 q; q.raw = r; return q; }
+
+  float toFloat() const { return (float)raw / 65536.0f; }
+  int16_t toInt() const { return (int16_t)((raw + 0x8000) >> 16); } // rounded
+
+  static int32_t addSat(int32_t a, int32_t b) {
+    int32_t r = (int32_t)((uint32_t)a + (uint32_t)b);
+    if (((a ^ r) & (b ^ r)) < 0) r = (a < 0) ? qMin : qMax;
+    return r;
+  }
+  static int32_t subSat(int32_t a, int32_t b) {
+    int32_t r = (int32_t)((uint32_t)a - (uint32_t)b);
+    if (((a ^ b) & (a ^ r)) < 0) r = (a < 0) ? qMin : qMax;
+    return r;
+  }
+
+  // Multiplies the magnitudes with 16x16->32 bit partial products only, which avoids the (slow on AVR)
+  // 64-bit multiply. The result is rounded to nearest, with ties away from zero.
+  static int32_t mulSat(int32_t a, int32_t b) {
+    bool neg = (a ^ b) < 0;
+    uint32_t ua = (a < 0) ? 0u - (uint32_t)a : (uint32_t)a;
+    uint32_t ub = (b < 0) ? 0u - (uint32_t)b : (uint32_t)b;
+    uint32_t lim = neg ? 0x80000000u : 0x7FFFFFFFu;
+    uint16_t ah = (uint16_t)(ua >> 16), bh = (uint16_t)(ub >> 16);
+    uint16_t al = (uint16_t)ua, bl = (uint16_t)ub;
+    uint32_t hi = (uint32_t)ah * bh;
+    uint32_t r = lim;
+    if (hi < 32768u) {
+      r = hi << 16;
+      r += (uint32_t)ah * bl;                        // each partial sum stays below 2^32
+      if (r < lim) r += (uint32_t)al * bh;
+      if (r < lim) r += ((uint32_t)al * bl + 0x8000u) >> 16;
+      if (r > lim) r = lim;
+    }
+    return neg ? (int32_t)(0u - r) : (int32_t)r;
+  }
+
+  qfix16 operator-() const { return fromRaw(raw == qMin ? qMax : -raw); }
+  qfix16 operator+(qfix16 b) const { return fromRaw(addSat(raw, b.raw)); }
+  qfix16 operator-(qfix16 b) const { return fromRaw(subSat(raw, b.raw)); }
+  qfix16 operator*(qfix16 b) const { return fromRaw(mulSat(raw, b.raw)); }
+  qfix16 &operator+=(qfix16 b) { return *this = *this + b; }
+  qfix16 &operator-=(qfix16 b) { return *this = *this - b; }
+  qfix16 &operator*=(qfix16 b) { return *this = *this * b; }
+
+  bool operator==(qfix16 b) const { return raw == b.raw; }
+  bool operator!=(qfix16 b) const { return raw != b.raw; }
+  bool operator<(qfix16 b) const { return raw < b.raw; }
+  bool operator>(qfix16 b) const { return raw > b.raw; }
+  bool operator<=(qfix16 b) const { return raw <= b.raw; }
+  bool operator>=(qfix16 b) const { return raw >= b.raw; }
+};
+
+/**********************************************************************************
+   QuickPIDFixed runs the same PID math and modes as QuickPID in Q16.16
+   fixed-point, so Compute() needs no floating point on FPU-less parts.
+   Tunings are given as float and pre-scaled to fixed-point by SetTunings()
+   and SetSampleTimeUs(), which are not time critical. Note that a pre-scaled
+   integral gain (Ki * sample time in seconds) smaller than 1/65536 rounds to 0.
+ **********************************************************************************/
+class QuickPIDFixed {
+
+  public:
+
+    typedef QuickPID::Control Control;
+    typedef QuickPID::Action Action;
+    typedef QuickPID::pMode pMode;
+    typedef QuickPID::dMode dMode;
+    typedef QuickPID::iAwMode iAwMode;
+
+    // Constructor. Links the PID to Input, Output, Setpoint, initial tuning parameters and control modes.
+    QuickPIDFixed(qfix16 *Input, qfix16 *Output, qfix16 *Setpoint, float Kp = 0, float Ki = 0, float Kd = 0,
+                  pMode pMode = pMode::pOnError, dMode dMode = dMode::dOnMeas,
+                  iAwMode iAwMode = iAwMode::iAwCondition, Action Action = Action::direct,
+                  tGetTimeMicros getMicros = QUICKPID_DEFAULT_CLOCK);
+
+    // Sets PID mode to manual (0), automatic (1) or timer (2).
+    void SetMode(Control Mode, tGetTimeMicros getMicros = NULL);
+
+    // Performs the PID calculation in fixed-point. Same timing behaviour as QuickPID::Compute().
+    bool Compute();
+
+    // Sets and clamps the output to a specific range (0-255 by default).
+    void SetOutputLimits(qfix16 Min, qfix16 Max);
+
+    // Sets the tunings and pre-scales them to fixed-point.
+    void SetTunings(float Kp, float Ki, float Kd);
+    void SetTunings(float Kp, float Ki, float Kd, pMode pMode, dMode dMode, iAwMode iAwMode);
+
+    void SetControllerDirection(Action Action);
+    void SetSampleTimeUs(uint32_t NewSampleTimeUs);
+    void SetProportionalMode(pMode pMode);
+    void SetDerivativeMode(dMode dMode);
+    void SetAntiWindupMode(iAwMode iAwMode);
+
+    // PID Query functions ****************************************************************************************
+    float GetKp();            // proportional gain
+    float GetKi();            // integral gain
+    float GetKd();            // derivative gain
+    qfix16 GetPterm();        // proportional component of output
+    qfix16 GetIterm();        // integral component of output
+    qfix16 GetDterm();        // derivative component of output
+    uint8_t GetMode();        // manual (0), automatic (1) or timer (2)
+    uint8_t GetDirection();   // direct (0), reverse (1)
+    uint8_t GetPmode();       // pOnError (0), pOnMeas (1), pOnErrorMeas (2)
+    uint8_t GetDmode();       // dOnError (0), dOnMeas (1)
+    uint8_t GetAwMode();      // iAwCondition (0, iAwClamp (1), iAwOff (2), iAwBackCalc (3)
+
+  private:
+
+    void Initialize();
+
+    float dispKp = 0;   // for defaults and display
+    float dispKi = 0;
+    float dispKd = 0;
+    qfix16 pTerm;
+    qfix16 iTerm;
+    qfix16 dTerm;
+
+    qfix16 kp;          // pre-scaled (P)roportional Tuning Parameter
+    qfix16 ki;          // pre-scaled (I)ntegral Tuning Parameter
+    qfix16 kd;          // pre-scaled (D)erivative Tuning Parameter
+
+    qfix16 *myInput;
+    qfix16 *myOutput;
+    qfix16 *mySetpoint;
+
+    tGetTimeMicros _getMicros;
+
+    Control mode = Control::manual;
+    Action action = Action::direct;
+    pMode pmode = pMode::pOnError;
+    dMode dmode = dMode::dOnMeas;
+    iAwMode iawmode = iAwMode::iAwCondition;
+
+    uint32_t sampleTimeUs = 100000, lastTime = 0;
+    qfix16 outputSum, outMin, outMax, error, lastError, lastInput;
+
+}; // class QuickPIDFixed
+#endif // QuickPIDFixed.h
@@ -0,0 +1,84 @@
+/**********************************************************************************
+   QuickPIDGainSchedule - constant time gain scheduling for QuickPID
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDGainSchedule.h"
+
+/* Constructor ********************************************************************/
+QuickPIDGainSchedule::QuickPIDGainSchedule(QuickPID &Pid, QuickPIDGains *Table, uint8_t Size,
+                                           float X0, float Step) : pid(Pid) {
+  table = Table;
+  size = Size;
+  x0 = X0;
+  invStep = (Step > 0) ? 1.0f / Step : 0;
+  for (uint8_t i = 0; i < size; i++) {
+    table[i].kp = pid.kp;
+    table[i].ki = pid.ki;
+    table[i].kd = pid.kd;
+  }
+}
+
+/* SetTunings(....)*****************************************************************
+   The slow part (validation and the divide by the sample time) is done here,
+   once per breakpoint, instead of every time the gains change.
+ **********************************************************************************/
+void QuickPIDGainSchedule::SetTunings(uint8_t i, float Kp, float Ki, float Kd) {
+  if (i >= size || Kp < 0 || Ki < 0 || Kd < 0) return;
+  sampleTimeSec = (float)pid.sampleTimeUs / 1000000;
+  invSampleTimeSec = 1.0f / sampleTimeSec;
+  table[i].kp = Kp;
+  table[i].ki = Ki * sampleTimeSec;
+  table[i].kd = Kd * invSampleTimeSec;
+  index = 0xFF; // reapply on the next Update()
+}
+
+void QuickPIDGainSchedule::SetInterpolation(bool Interpolate) {
+  interpolate = Interpolate;
+  index = 0xFF;
+}
+
+/* Update(.)***********************************************************************
+   The breakpoint index is (x - x0) / step, computed with the stored reciprocal.
+   Without interpolation, nothing is done while x stays in the same interval.
+   For a bumpless change, outputSum absorbs the step in the proportional on
+   error term that the new kp would otherwise put on the output.
+ **********************************************************************************/
+void QuickPIDGainSchedule::Update(float x) {
+  if (size == 0) return;
+  float pos = (x - x0) * invStep;
+  uint8_t i = 0;
+  float frac = 0;
+  if (pos >= (float)(size - 1)) i = size - 1;
+  else if (pos > 0) {
+    i = (uint8_t)pos;
+    frac = pos - (float)i;
+  }
+  if (!interpolate && i == index) return;
+  index = i;
+
+  float kp = table[i].kp, ki = table[i].ki, kd = table[i].kd;
+  if (interpolate && frac > 0) {
+    kp += frac * (table[i + 1].kp - kp);
+    ki += frac * (table[i + 1].ki - ki);
+    kd += frac * (table[i + 1].kd - kd);
+  }
+
+  if (pid.pmode != QuickPID::pMode::pOnMeas && pid.mode != QuickPID::Control::manual) {
+    float peFactor = (pid.pmode == QuickPID::pMode::pOnError) ? 1.0f : 0.5f;
+    pid.outputSum -= (kp - pid.kp) * pid.lastError * peFactor;
+    if (pid.iawmode != QuickPID::iAwMode::iAwOff && pid.iawmode != QuickPID::iAwMode::iAwBackCalc) {
+      pid.outputSum = CONSTRAIN(pid.outputSum, pid.outMin, pid.outMax);
+    }
+  }
+  pid.kp = kp;
+  pid.ki = ki;
+  pid.kd = kd;
+  pid.dispKp = kp;
+  pid.dispKi = ki * invSampleTimeSec;
+  pid.dispKd = kd * sampleTimeSec;
+}
+
+uint8_t QuickPIDGainSchedule::GetIndex() {
+  return index;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef QuickPIDGainSchedule_h
+#define QuickPIDGainSchedule_h
+
+#include "QuickPID.h"
+
+// Pre-scaled gains, as used inside Compute() (ki and kd include the sample time).
+struct QuickPIDGains {
+  float kp, ki, kd;
+};
+
+/**********************************************************************************
+   QuickPIDGainSchedule selects a controller's gains from a table of pre-scaled
+   gain sets at equally spaced breakpoints x0, x0 + step, x0 + 2 * step, ...
+   The scheduling variable can be the error, the setpoint or any external
+   value. Lookup is constant time (no search or divide), with optional linear
+   interpolation between breakpoints. Switching gains is bumpless: the change
+   in the proportional on error term is moved into the integral sum, as
+   Initialize() does for a manual to automatic transfer.
+
+   The table memory is supplied by the user, so it can be sized as needed.
+   Fill it with SetTunings() after the controller's sample time is set.
+ **********************************************************************************/
+class QuickPIDGainSchedule {
+
+  public:
+
+    // Links the schedule to a controller and a table of Size gain sets with breakpoints X0 + i * Step.
+    QuickPIDGainSchedule(QuickPID &Pid, QuickPIDGains *Table, uint8_t Size, float X0, float Step);
+
+    // Pre-scales and stores the gain set for breakpoint i, the same as QuickPID::SetTunings() would.
+    void SetTunings(uint8_t i, float Kp, float Ki, float Kd);
+
+    // Enables or disables linear interpolation between breakpoints (off by default).
+    void SetInterpolation(bool Interpolate);
+
+    // Looks up the gains for scheduling variable x and applies them bumplessly. Values outside
+    // the table use the first or last gain set. Call before Compute().
+    void Update(float x);
+
+    // Returns the breakpoint index selected by the last Update().
+    uint8_t GetIndex();
+
+  private:
+
+    QuickPID &pid;
+    QuickPIDGains *table;
+    uint8_t size;
+    uint8_t index = 0xFF;       // last applied breakpoint, 0xFF before the first Update()
+    bool interpolate = false;
+    float x0, invStep;
+    float sampleTimeSec = 0.1f; // sample time the table is scaled for, to recover the display gains
+    float invSampleTimeSec = 10.0f;
+
+}; // class QuickPIDGainSchedule
+#endif // QuickPIDGainSchedule.h
@@ -0,0 +1,76 @@
+/**********************************************************************************
+   QuickPIDIsr - interrupt driven QuickPID with double-buffered parameters
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDIsr.h"
+
+/* Constructor ********************************************************************/
+QuickPIDIsr::QuickPIDIsr(QuickPID &Pid) : pid(Pid) {
+  seq = 0;
+  appliedSeq = 0;
+  Params p;
+  p.setpoint = *pid.mySetpoint;
+  p.kp = pid.kp;
+  p.ki = pid.ki;
+  p.kd = pid.kd;
+  Publish(p);
+}
+
+/* Publish(.)**********************************************************************
+   Writes the unpublished slot, then flips to it with a single byte store. The
+   interrupt only reads the published slot, so it never sees a partial update.
+ **********************************************************************************/
+void QuickPIDIsr::Publish(const Params &p) {
+  uint8_t next = seq + 1;
+  volatile Params &s = slot[next & 1];
+  s.setpoint = p.setpoint;
+  s.kp = p.kp;
+  s.ki = p.ki;
+  s.kd = p.kd;
+  seq = next;
+}
+
+void QuickPIDIsr::SetSetpoint(float Setpoint) {
+  volatile Params &cur = slot[seq & 1];
+  Params p;
+  p.setpoint = Setpoint;
+  p.kp = cur.kp;
+  p.ki = cur.ki;
+  p.kd = cur.kd;
+  Publish(p);
+}
+
+/* SetTunings(...)*****************************************************************
+   Same validation and pre-scaling as QuickPID::SetTunings(), done here in the
+   main context so the interrupt only copies the results.
+ **********************************************************************************/
+void QuickPIDIsr::SetTunings(float Kp, float Ki, float Kd) {
+  if (Kp < 0 || Ki < 0 || Kd < 0) return;
+  pid.dispKp = Kp; pid.dispKi = Ki; pid.dispKd = Kd;
+  float SampleTimeSec = (float)pid.sampleTimeUs / 1000000;
+  Params p;
+  p.setpoint = slot[seq & 1].setpoint;
+  p.kp = Kp;
+  p.ki = Ki * SampleTimeSec;
+  p.kd = Kd / SampleTimeSec;
+  Publish(p);
+}
+
+/* Compute() ***********************************************************************/
+bool QuickPIDIsr::Compute() {
+  uint8_t s = seq;
+  if (s != appliedSeq) {
+    volatile Params &p = slot[s & 1];
+    *pid.mySetpoint = p.setpoint;
+    pid.kp = p.kp;
+    pid.ki = p.ki;
+    pid.kd = p.kd;
+    appliedSeq = s;
+  }
+  return pid.ComputeFromISR();
+}
+
+float QuickPIDIsr::GetSetpoint() {
+  return slot[seq & 1].setpoint;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef QuickPIDIsr_h
+#define QuickPIDIsr_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDIsr runs a QuickPID directly inside a timer interrupt and lets the
+   main context publish a new setpoint and tunings without tearing.
+
+   SetSetpoint() and SetTunings() run in the main context. They pre-scale the
+   gains and write a complete copy of the parameters into the unpublished half
+   of a double buffer, then publish it with a single byte store. Compute() runs
+   in the interrupt, applies the latest published parameters (if changed) and
+   calls QuickPID::ComputeFromISR(). While QuickPIDIsr is in use, change the
+   setpoint and tunings only through it. This is safe on single core parts,
+   where the interrupt always runs to completion before the main context resumes.
+
+   QuickPID myPID(&Input, &Output, &Setpoint, Kp, Ki, Kd, myPID.Action::direct);
+   QuickPIDIsr isrPID(myPID);
+   void timerIsr() { Input = analogRead(0); isrPID.Compute(); analogWrite(3, Output); }
+ **********************************************************************************/
+class QuickPIDIsr {
+
+  public:
+
+    // Links to the controller and publishes its current setpoint and tunings.
+    QuickPIDIsr(QuickPID &Pid);
+
+    // Publishes a new setpoint. Main context only.
+    void SetSetpoint(float Setpoint);
+
+    // Publishes new tunings, pre-scaled by the controller's sample time. Main context only.
+    void SetTunings(float Kp, float Ki, float Kd);
+
+    // Applies any newly published parameters and performs the PID calculation. Interrupt context only.
+    bool Compute();
+
+    // Returns the most recently published setpoint.
+    float GetSetpoint();
+
+  private:
+
+    struct Params {
+      float setpoint, kp, ki, kd;
+    };
+
+    void Publish(const Params &p);
+
+    QuickPID &pid;
+    volatile Params slot[2];     // double buffer, slot[seq & 1] is published
+    volatile uint8_t seq;        // incremented by each publish
+    uint8_t appliedSeq;          // last seq applied by Compute()
+
+}; // class QuickPIDIsr
+#endif // QuickPIDIsr.h
@@ -0,0 +1,99 @@
+#pragma once
+#ifndef QuickPIDLite_h
+#define QuickPIDLite_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDLite is a memory-lean BasicQuickPID. It keeps only the state that
+   Compute() needs: the scaled gains, the limits, the integral sum and the last
+   input and error (32 bytes, one cache line on a Cortex-M7), plus the sample
+   time. There are no Input/Output/Setpoint links, clock or mode: the input and
+   setpoint are passed to Compute(), which returns the output, and the caller
+   runs it once per sample time (like timer mode). The display gains are
+   recomputed from the scaled gains and the sample time.
+
+   QuickPIDLite<> myPID(2, 5, 1);
+   ...
+   Output = myPID.Compute(analogRead(PIN_INPUT), Setpoint);
+ **********************************************************************************/
+template <QuickPID::Action TAction = QuickPID::Action::direct,
+          QuickPID::pMode TpMode = QuickPID::pMode::pOnError,
+          QuickPID::dMode TdMode = QuickPID::dMode::dOnMeas,
+          QuickPID::iAwMode TiAwMode = QuickPID::iAwMode::iAwCondition>
+class QuickPIDLite {
+
+  public:
+
+    typedef QuickPID::Action Action;
+    typedef QuickPID::pMode pMode;
+    typedef QuickPID::dMode dMode;
+    typedef QuickPID::iAwMode iAwMode;
+
+    // Constructor. Sets the initial tuning parameters and output limits of 0 to 255.
+    QuickPIDLite(float Kp = 0, float Ki = 0, float Kd = 0) {
+      SetTunings(Kp, Ki, Kd);
+    }
+
+    // Bumpless start from the current Input and Output.
+    void Initialize(float Input, float Output) {
+      outputSum = CONSTRAIN(Output, outMin, outMax);
+      lastInput = Input;
+      lastError = 0;
+    }
+
+    // Performs one PID calculation and returns the output. Same math as BasicQuickPID::Compute().
+    float Compute(float Input, float Setpoint) {
+      float error, pTerm, iTerm, dTerm;
+      return QuickPIDStep(TAction, TpMode, TdMode, TiAwMode, Input, Setpoint,
+                          kp, ki, kd, outMin, outMax, outputSum, lastInput, lastError,
+                          error, pTerm, iTerm, dTerm);
+    }
+
+    // Sets the output range (0-255 by default) and clamps the integral sum to it.
+    void SetOutputLimits(float Min, float Max) {
+      if (Min >= Max) return;
+      outMin = Min;
+      outMax = Max;
+      outputSum = CONSTRAIN(outputSum, outMin, outMax);
+    }
+
+    // Sets the tunings. The controller modes are fixed by the template parameters.
+    void SetTunings(float Kp, float Ki, float Kd) {
+      if (Kp < 0 || Ki < 0 || Kd < 0) return;
+      float SampleTimeSec = (float)sampleTimeUs / 1000000;
+      kp = Kp;
+      ki = Ki * SampleTimeSec;
+      kd = Kd / SampleTimeSec;
+    }
+
+    // Sets the sample time in microseconds at which the caller runs Compute(). Default is 100000 µs.
+    void SetSampleTimeUs(uint32_t NewSampleTimeUs) {
+      if (NewSampleTimeUs > 0) {
+        float ratio = (float)NewSampleTimeUs / (float)sampleTimeUs;
+        ki *= ratio;
+        kd /= ratio;
+        sampleTimeUs = NewSampleTimeUs;
+      }
+    }
+
+    // PID Query functions ****************************************************************************************
+    float GetKp() { return kp; }
+    float GetKi() { return ki * 1000000 / (float)sampleTimeUs; }
+    float GetKd() { return kd * (float)sampleTimeUs / 1000000; }
+    float GetOutputSum() { return outputSum; }
+    uint32_t GetSampleTimeUs() { return sampleTimeUs; }
+    uint8_t GetDirection() { return static_cast<uint8_t>(TAction); }
+    uint8_t GetPmode() { return static_cast<uint8_t>(TpMode); }
+    uint8_t GetDmode() { return static_cast<uint8_t>(TdMode); }
+    uint8_t GetAwMode() { return static_cast<uint8_t>(TiAwMode); }
+
+  private:
+
+    float kp = 0, ki = 0, kd = 0;
+    float outMin = 0, outMax = 255;  // same default as Arduino PWM limit
+    float outputSum = 0, lastInput = 0, lastError = 0;
+    uint32_t sampleTimeUs = 100000;  // 0.1 sec default
+
+}; // class QuickPIDLite
+#endif // QuickPIDLite.h
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef QuickPIDMailbox_h
+#define QuickPIDMailbox_h
+
+#include "QuickPIDClock.h"
+#include <string.h>
+
+/**********************************************************************************
+   QuickPIDMailbox holds the latest value of T for one writer and one reader,
+   which may run on different cores or in different tasks or interrupts. It's
+   a sequence lock: the writer makes the sequence odd, writes the value and
+   makes it even again, with barriers in between. The reader copies the value
+   and keeps it only if the sequence was even and unchanged around the copy.
+
+   Neither side waits. Write() always completes, and a Read() that overlaps a
+   write returns false and leaves Value as it was, so a high priority reader
+   never spins on a preempted writer; it gets the value on its next Read().
+   T must be plain data (copied with memcpy).
+
+   QuickPIDMailbox<QuickPIDCommand> command;
+   command.Write(c);               // application core
+   if (command.Read(c)) { ... }    // control core, true when c is new
+ **********************************************************************************/
+template <typename T>
+class QuickPIDMailbox {
+
+  public:
+
+#if defined(__AVR__)
+    typedef uint8_t seq_t;
+#else
+    typedef uint32_t seq_t;
+#endif
+
+    QuickPIDMailbox() {
+      memset(&value, 0, sizeof(value));
+    }
+
+    // Publishes a new value. Writer only.
+    void Write(const T &Value) {
+      seq_t s = seq;
+      seq = s + 1;
+      __sync_synchronize();
+      memcpy(&value, &Value, sizeof(T));
+      __sync_synchronize();
+      seq = s + 2;
+    }
+
+    // Copies the latest value into Value. Reader only. Returns true if a value was written since the last
+    // successful Read(), false if not or if a write was in progress (Value is then unchanged).
+    bool Read(T &Value) {
+      seq_t s = seq;
+      if ((s & 1) != 0 || s == readSeq) return false;
+      __sync_synchronize();
+      T copy;
+      memcpy(&copy, &value, sizeof(T));
+      __sync_synchronize();
+      if (seq != s) return false;
+      Value = copy;
+      readSeq = s;
+      return true;
+    }
+
+  private:
+
+    T value;
+    volatile seq_t seq = 0;      // odd while a write is in progress
+    seq_t readSeq = 0;           // seq of the last value read
+
+}; // class QuickPIDMailbox
+#endif // QuickPIDMailbox.h
@@ -0,0 +1,72 @@
+/**********************************************************************************
+   QuickPIDPlant - discrete process models for simulating QuickPID
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDPlant.h"
+#include <math.h>
+
+/* Constructor ********************************************************************/
+QuickPIDPlant::QuickPIDPlant(float *Buffer, uint16_t BufferSize) {
+  buffer = Buffer;
+  bufferSize = (Buffer != NULL) ? BufferSize : 0;
+}
+
+/* SetModel(......)****************************************************************
+   A lag with time constant T over one sample Ts is y += (1 - exp(-Ts / T)) * (x - y)
+   for a constant x, which is exact for a zero order hold Output. A time
+   constant of 0 makes the lag a pass through. The dead time is limited to
+   the buffer size.
+ **********************************************************************************/
+void QuickPIDPlant::SetModel(Model Model, float Gain, float T1, float T2, float DeadTimeSec, float SampleTimeSec) {
+  if (T1 < 0 || T2 < 0 || DeadTimeSec < 0 || SampleTimeSec <= 0) return;
+  model = Model;
+  gain = Gain;
+  gainTs = Gain * SampleTimeSec;
+  a1 = (T1 > 0) ? 1.0f - expf(-SampleTimeSec / T1) : 1.0f;
+  a2 = (T2 > 0) ? 1.0f - expf(-SampleTimeSec / T2) : 1.0f;
+  float samples = DeadTimeSec / SampleTimeSec + 0.5f;
+  delay = (samples < (float)bufferSize) ? (uint16_t)samples : bufferSize;
+  Reset(pv);
+}
+
+void QuickPIDPlant::Reset(float Pv, float U) {
+  pv = Pv;
+  x1 = (model == Model::sopdt) ? Pv : 0;
+  for (uint16_t i = 0; i < delay; i++) buffer[i] = U;
+  head = 0;
+}
+
+/* Step(.)*************************************************************************
+   The dead time buffer is a ring of delay samples: the oldest Output is read
+   and replaced by the newest.
+ **********************************************************************************/
+float QuickPIDPlant::Step(float U) {
+  float u = U;
+  if (delay) {
+    u = buffer[head];
+    buffer[head] = U;
+    if (++head >= delay) head = 0;
+  }
+  switch (model) {
+    case Model::integrating:
+      pv += gainTs * u;
+      break;
+    case Model::sopdt:
+      x1 += a1 * (gain * u - x1);
+      pv += a2 * (x1 - pv);
+      break;
+    default: // fopdt
+      pv += a1 * (gain * u - pv);
+      break;
+  }
+  return pv;
+}
+
+/* Status Functions************************************************************/
+float QuickPIDPlant::GetPv() {
+  return pv;
+}
+uint16_t QuickPIDPlant::GetDeadTimeSamples() {
+  return delay;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef QuickPIDPlant_h
+#define QuickPIDPlant_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDPlant is a discrete process model for testing and tuning a QuickPID
+   without hardware, on the target or on a host. Each Step() applies one
+   sample of the controller Output and returns the new process value, which is
+   the controller Input. The lags are discretized exactly (zero order hold),
+   with the coefficients computed once in SetModel(), so Step() is a few
+   multiply-adds.
+
+   fopdt        first order plus dead time, Gain / (T1 s + 1)
+   integrating  Gain / s, for example a level or position
+   sopdt        second order plus dead time, Gain / ((T1 s + 1)(T2 s + 1))
+
+   The dead time is rounded to whole samples and needs a buffer of at least
+   that many floats, supplied by the user.
+ **********************************************************************************/
+class QuickPIDPlant {
+
+  public:
+
+    enum class Model : uint8_t {fopdt, integrating, sopdt};
+
+    // Constructor. Buffer holds up to BufferSize samples of dead time.
+    QuickPIDPlant(float *Buffer = NULL, uint16_t BufferSize = 0);
+
+    // Sets the model, process gain, time constants and dead time in seconds, and the sample time in
+    // seconds at which Step() is called. T2 is only used by sopdt.
+    void SetModel(Model Model, float Gain, float T1, float T2, float DeadTimeSec, float SampleTimeSec);
+
+    // Sets the process value, and fills the dead time with the Output U.
+    void Reset(float Pv = 0, float U = 0);
+
+    // Applies the Output U for one sample. Returns the new process value.
+    float Step(float U);
+
+    // Query functions.
+    float GetPv();
+    uint16_t GetDeadTimeSamples();
+
+  private:
+
+    float *buffer;
+    uint16_t bufferSize;
+    uint16_t delay = 0;         // dead time in samples
+    uint16_t head = 0;          // oldest sample in the dead time buffer
+
+    Model model = Model::fopdt;
+    float gain = 1;
+    float a1 = 1, a2 = 1;       // lag coefficients 1 - exp(-Ts / T)
+    float gainTs = 0;           // Gain * Ts, integrating model
+    float x1 = 0, pv = 0;       // first lag output, process value
+
+}; // class QuickPIDPlant
+#endif // QuickPIDPlant.h
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef QuickPIDScheduler_h
+#define QuickPIDScheduler_h
+
+#include "QuickPID.h"
+
+/**********************************************************************************
+   QuickPIDScheduler runs up to N QuickPID controllers with different sample
+   times from one clock read per call. The controllers are kept in a binary
+   min-heap ordered by their next due time, so ComputeDue() only looks at the
+   controllers that are due and stops at the first one that isn't. Each due
+   controller is computed with ComputeFromISR() (no clock read of its own), and
+   its next due time is advanced by its sample time, so it keeps its phase.
+
+   A controller that is a whole sample time or more late has missed a sample.
+   That is counted as an overrun, and it's rescheduled from now instead of
+   computing the missed samples back to back. The largest lateness is also
+   kept. The clock is in microseconds.
+
+   The controllers are set to automatic or timer mode as usual (manual ones
+   are skipped but stay scheduled); don't also call their Compute().
+
+   QuickPIDScheduler<40> scheduler;
+   scheduler.Add(myPID);  // for each controller
+   ...
+   void loop() { scheduler.ComputeDue(); }
+ **********************************************************************************/
+template <uint8_t N>
+class QuickPIDScheduler {
+
+  public:
+
+    // Constructor. Optionally sets the microsecond clock used by ComputeDue().
+    QuickPIDScheduler(tGetTimeMicros getMicros = QUICKPID_DEFAULT_CLOCK) {
+      _getMicros = getMicros;
+    }
+
+    // Adds a controller and returns its index (0 to N - 1, so up to 254), or -1 when full. This restarts the
+    // schedule: every controller is due on the next ComputeDue().
+    int16_t Add(QuickPID &Pid) {
+      if (count >= N) return -1;
+      pid[count] = &Pid;
+      overruns[count] = 0;
+      count++;
+      started = false;
+      return count - 1;
+    }
+
+    // Reads the clock once and computes every controller that is due. Returns the number computed.
+    uint8_t ComputeDue() {
+      if (_getMicros == NULL) return 0;
+      return ComputeDue(_getMicros());
+    }
+
+    // Same, with the current time given by the caller.
+    uint8_t ComputeDue(uint32_t nowUs) {
+      if (!started) Start(nowUs);
+      uint8_t computed = 0;
+      while (count > 0) {
+        uint8_t i = heap[0];
+        uint32_t late = nowUs - due[i];
+        if ((int32_t)late < 0) break;  // the earliest one isn't due yet
+        QuickPID &p = *pid[i];
+        if (p.ComputeFromISR()) computed++;
+        if (late >= p.sampleTimeUs) {
+          overruns[i]++;
+          totalOverruns++;
+          due[i] = nowUs + p.sampleTimeUs;
+        } else {
+          due[i] += p.sampleTimeUs;
+        }
+        if (late > maxLateness) maxLateness = late;
+        SiftDown(0);
+      }
+      return computed;
+    }
+
+    // Returns the microseconds until the next controller is due, 0 if one is due now, so the caller can sleep.
+    uint32_t TimeToNext(uint32_t nowUs) {
+      if (count == 0 || !started) return 0;
+      uint32_t wait = due[heap[0]] - nowUs;
+      return ((int32_t)wait > 0) ? wait : 0;
+    }
+
+    // Returns the overruns of controller i (missed samples), or of all controllers.
+    uint32_t GetOverruns(uint8_t i) { return overruns[i]; }
+    uint32_t GetOverruns() { return totalOverruns; }
+
+    // Returns the largest time in microseconds that a controller was computed after it was due.
+    uint32_t GetMaxLateness() { return maxLateness; }
+
+    void ResetOverruns() {
+      for (uint8_t i = 0; i < count; i++) overruns[i] = 0;
+      totalOverruns = 0;
+      maxLateness = 0;
+    }
+
+  private:
+
+    // Makes every controller due now and builds the heap.
+    void Start(uint32_t nowUs) {
+      for (uint8_t i = 0; i < count; i++) {
+        heap[i] = i;
+        due[i] = nowUs;
+      }
+      started = true;
+    }
+
+    // Clock wrap safe due time order.
+    bool Before(uint8_t a, uint8_t b) {
+      return (int32_t)(due[a] - due[b]) < 0;
+    }
+
+    // Moves the entry at k down to restore the heap order after its due time increased.
+    void SiftDown(uint16_t k) {
+      for (;;) {
+        uint16_t c = 2 * k + 1;
+        if (c >= count) return;
+        if (c + 1 < count && Before(heap[c + 1], heap[c])) c++;
+        if (!Before(heap[c], heap[k])) return;
+        uint8_t t = heap[k];
+        heap[k] = heap[c];
+        heap[c] = t;
+        k = c;
+      }
+    }
+
+    QuickPID *pid[N];
+    uint32_t due[N];             // next due time of each controller
+    uint32_t overruns[N];
+    uint8_t heap[N];             // controller indices, earliest due first
+    uint8_t count = 0;
+    bool started = false;
+    uint32_t totalOverruns = 0;
+    uint32_t maxLateness = 0;
+    tGetTimeMicros _getMicros;
+
+}; // class QuickPIDScheduler
+#endif // QuickPIDScheduler.h
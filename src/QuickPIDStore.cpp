@@ -0,0 +1,89 @@
+/**********************************************************************************
+   QuickPIDStore - wear-leveled state snapshots for QuickPID warm starts
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDStore.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Constructor ********************************************************************/
+QuickPIDStore::QuickPIDStore(tStoreRead Read, tStoreWrite Write, uint32_t BaseAddress, uint8_t Slots) {
+  read = Read;
+  write = Write;
+  base = BaseAddress;
+  slots = (Slots > 0) ? Slots : 1;
+}
+
+uint16_t QuickPIDStore::GetRecordSize() {
+  return sizeof(Record);
+}
+
+/* Crc(.)**************************************************************************
+   CRC-16/CCITT of the record up to the crc field. The record is cleared before
+   it's filled, so the padding bytes are deterministic.
+ **********************************************************************************/
+uint16_t QuickPIDStore::Crc(const Record &r) {
+  const uint8_t *p = (const uint8_t *)&r;
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < offsetof(Record, crc); i++) {
+    crc ^= (uint16_t)p[i] << 8;
+    for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+/* Find()**************************************************************************
+   The newest record is the valid one with the highest sequence number,
+   compared with wrap so the sequence can run forever.
+ **********************************************************************************/
+bool QuickPIDStore::Find() {
+  found = false;
+  Record r;
+  for (uint8_t i = 0; i < slots; i++) {
+    if (!read(base + (uint32_t)i * sizeof(Record), &r, sizeof(Record))) continue;
+    if (r.crc != Crc(r) || r.state.version != QUICKPID_STATE_VERSION) continue;
+    if (!found || (int32_t)(r.seq - seq) > 0) {
+      found = true;
+      slot = i;
+      seq = r.seq;
+    }
+  }
+  return found;
+}
+
+bool QuickPIDStore::Save(QuickPID &Pid) {
+  if (!found) Find();
+  Record r;
+  memset(&r, 0, sizeof(r));
+  uint8_t next = found ? (uint8_t)((slot + 1) % slots) : 0;
+  r.seq = found ? seq + 1 : 1;
+  Pid.GetState(r.state);
+  r.crc = Crc(r);
+  if (!write(base + (uint32_t)next * sizeof(Record), &r, sizeof(Record))) return false;
+  found = true;
+  slot = next;
+  seq = r.seq;
+  return true;
+}
+
+/* Update(...)*********************************************************************
+   The first call only starts the interval, so a reset doesn't cost a write.
+ **********************************************************************************/
+bool QuickPIDStore::Update(QuickPID &Pid, uint32_t NowMs, uint32_t IntervalMs) {
+  if (!started) {
+    started = true;
+    lastSave = NowMs;
+    return false;
+  }
+  if ((uint32_t)(NowMs - lastSave) < IntervalMs) return false;
+  lastSave = NowMs;
+  return Save(Pid);
+}
+
+bool QuickPIDStore::Restore(QuickPID &Pid) {
+  if (!Find()) return false;
+  Record r;
+  if (!read(base + (uint32_t)slot * sizeof(Record), &r, sizeof(Record))) return false;
+  return Pid.SetState(r.state);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef QuickPIDStore_h
+#define QuickPIDStore_h
+
+#include "QuickPID.h"
+
+// Reads or writes Size bytes at Address of the nonvolatile memory. Returns false on failure.
+typedef bool (*tStoreRead)(uint32_t Address, void *Data, uint16_t Size);
+typedef bool (*tStoreWrite)(uint32_t Address, const void *Data, uint16_t Size);
+
+/**********************************************************************************
+   QuickPIDStore saves QuickPID state snapshots to EEPROM or flash, and
+   restores the newest one after a reset. Consecutive saves go to the next of
+   Slots records in turn, which spreads the wear over Slots times the memory.
+   Each record holds a sequence number and a CRC, so a record torn by a power
+   loss during the write is skipped and the previous one is used.
+
+   The memory is accessed through user functions, for example with EEPROM.h
+
+   bool eeRead(uint32_t a, void *d, uint16_t n) { uint8_t *p = (uint8_t *)d; while (n--) *p++ = EEPROM.read(a++); return true; }
+   bool eeWrite(uint32_t a, const void *d, uint16_t n) { const uint8_t *p = (const uint8_t *)d; while (n--) EEPROM.update(a++, *p++); return true; }
+   QuickPIDStore store(eeRead, eeWrite, 0, 8);   // 8 records from address 0
+ **********************************************************************************/
+class QuickPIDStore {
+
+  public:
+
+    // Constructor. The records take Slots * GetRecordSize() bytes from BaseAddress.
+    QuickPIDStore(tStoreRead Read, tStoreWrite Write, uint32_t BaseAddress, uint8_t Slots);
+
+    // Saves the controller's state to the next record. Returns false if the write failed.
+    bool Save(QuickPID &Pid);
+
+    // Saves every IntervalMs, when called from loop() with millis(). Returns true when it saved.
+    bool Update(QuickPID &Pid, uint32_t NowMs, uint32_t IntervalMs);
+
+    // Restores the newest valid record into the controller. Returns false if there is none.
+    bool Restore(QuickPID &Pid);
+
+    // Bytes per record.
+    static uint16_t GetRecordSize();
+
+  private:
+
+    struct Record {
+      uint32_t seq;
+      QuickPIDState state;
+      uint16_t crc;
+    };
+
+    static uint16_t Crc(const Record &r);
+    bool Find();                // locates the newest valid record
+
+    tStoreRead read;
+    tStoreWrite write;
+    uint32_t base;
+    uint8_t slots;
+    bool found = false;         // newest record located
+    uint8_t slot = 0;           // newest record
+    uint32_t seq = 0;           // its sequence number
+    uint32_t lastSave = 0;      // millis() of the previous Update() save
+    bool started = false;
+
+}; // class QuickPIDStore
+#endif // QuickPIDStore.h
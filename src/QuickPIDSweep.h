@@ -0,0 +1,249 @@
+#pragma once
+#ifndef QuickPIDSweep_h
+#define QuickPIDSweep_h
+
+#include "QuickPID.h"
+#include "QuickPIDPlant.h"
+#include <math.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A set of SetTunings() arguments to evaluate.
+struct QuickPIDCandidate {
+  float kp, ki, kd;
+  QuickPID::pMode pmode;
+  QuickPID::dMode dmode;
+  QuickPID::iAwMode iawmode;
+};
+
+// Step response of one candidate. Overshoot is in percent of the step, times are in seconds.
+struct QuickPIDMetrics {
+  float iae, itae, overshoot, settlingTime, cost;
+};
+
+/**********************************************************************************
+   QuickPIDSweep finds the best tunings for a QuickPIDPlant model on a host.
+   Each candidate runs a setpoint step from 0 through the same QuickPID
+   Compute() used on the target, and is scored by a weighted sum of IAE,
+   ITAE, overshoot and settling time. Candidates are evaluated in parallel
+   on a work-stealing pool: each thread starts with an equal share and, when
+   it runs out, takes half of the remaining work of another thread. Results
+   don't depend on the number of threads.
+
+   Host only (needs std::thread), header-only so Arduino builds don't see it.
+ **********************************************************************************/
+class QuickPIDSweep {
+
+  public:
+
+    // Sets the plant model, the sample time, the setpoint step and the length of each test.
+    QuickPIDSweep(QuickPIDPlant::Model Model, float Gain, float T1, float T2, float DeadTimeSec,
+                  float SampleTimeSec, float Setpoint, float DurationSec,
+                  QuickPID::Action Action = QuickPID::Action::direct) {
+      model = Model;
+      gain = Gain;
+      t1 = T1;
+      t2 = T2;
+      deadTimeSec = DeadTimeSec;
+      sampleTimeSec = (SampleTimeSec > 0) ? SampleTimeSec : 0.1f;
+      setpoint = Setpoint;
+      samples = (uint32_t)(DurationSec / sampleTimeSec + 0.5f);
+      action = Action;
+    }
+
+    // Sets the controller output limits used in the tests (default 0 to 255).
+    void SetOutputLimits(float Min, float Max) {
+      if (Min >= Max) return;
+      outMin = Min;
+      outMax = Max;
+    }
+
+    // Sets the cost weights. The default is IAE only.
+    void SetWeights(float Iae, float Itae, float Overshoot, float SettlingTime) {
+      wIae = Iae;
+      wItae = Itae;
+      wOvershoot = Overshoot;
+      wSettling = SettlingTime;
+    }
+
+    // Sets the settling band as a fraction of the step (default 0.02).
+    void SetSettlingBand(float Fraction) {
+      if (Fraction > 0) band = Fraction;
+    }
+
+    // Runs the step test for one candidate.
+    QuickPIDMetrics Evaluate(const QuickPIDCandidate &c) const {
+      std::vector<float> buffer(DeadTimeSamples());
+      return Evaluate(c, buffer.data());
+    }
+
+    // Evaluates Count candidates on Threads threads (0 uses all cores). Fills Metrics (if not NULL)
+    // and returns the index of the lowest cost, the first one on a tie.
+    size_t Run(const QuickPIDCandidate *Candidates, size_t Count, QuickPIDMetrics *Metrics = NULL,
+               unsigned Threads = 0) const {
+      if (Count == 0) return 0;
+      unsigned n = (Threads > 0) ? Threads : std::thread::hardware_concurrency();
+      if (n == 0) n = 1;
+      if (n > Count) n = (unsigned)Count;
+
+      std::vector<Worker> worker(n);
+      for (unsigned w = 0; w < n; w++) {
+        worker[w].next = Count * w / n;
+        worker[w].end = Count * (w + 1) / n;
+      }
+      std::vector<std::thread> pool;
+      for (unsigned w = 1; w < n; w++) {
+        pool.push_back(std::thread(&QuickPIDSweep::Work, this, Candidates, Metrics, &worker, w));
+      }
+      Work(Candidates, Metrics, &worker, 0);
+      for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+
+      size_t best = worker[0].best;
+      float bestCost = worker[0].bestCost;
+      for (unsigned w = 1; w < n; w++) {
+        if (worker[w].bestCost < bestCost || (worker[w].bestCost == bestCost && worker[w].best < best)) {
+          best = worker[w].best;
+          bestCost = worker[w].bestCost;
+        }
+      }
+      return best;
+    }
+
+    // Builds a grid of Kp, Ki and Kd values from Min to Max in N linear steps. With AllModes, every
+    // combination of proportional, derivative and anti-windup mode is added, otherwise only the given modes.
+    static std::vector<QuickPIDCandidate> Grid(float KpMin, float KpMax, uint16_t KpN,
+                                               float KiMin, float KiMax, uint16_t KiN,
+                                               float KdMin, float KdMax, uint16_t KdN, bool AllModes = false,
+                                               QuickPID::pMode pMode = QuickPID::pMode::pOnError,
+                                               QuickPID::dMode dMode = QuickPID::dMode::dOnMeas,
+                                               QuickPID::iAwMode iAwMode = QuickPID::iAwMode::iAwCondition) {
+      std::vector<QuickPIDCandidate> grid;
+      uint8_t modes = AllModes ? 24 : 1;
+      for (uint8_t m = 0; m < modes; m++) {
+        QuickPIDCandidate c;
+        c.pmode = AllModes ? (QuickPID::pMode)(m / 8) : pMode;
+        c.dmode = AllModes ? (QuickPID::dMode)((m / 4) % 2) : dMode;
+        c.iawmode = AllModes ? (QuickPID::iAwMode)(m % 4) : iAwMode;
+        for (uint16_t p = 0; p < KpN; p++) {
+          c.kp = Lin(KpMin, KpMax, p, KpN);
+          for (uint16_t i = 0; i < KiN; i++) {
+            c.ki = Lin(KiMin, KiMax, i, KiN);
+            for (uint16_t d = 0; d < KdN; d++) {
+              c.kd = Lin(KdMin, KdMax, d, KdN);
+              grid.push_back(c);
+            }
+          }
+        }
+      }
+      return grid;
+    }
+
+  private:
+
+    // One thread's share [next, end) and its best result so far.
+    struct Worker {
+      std::mutex lock;
+      size_t next = 0, end = 0;
+      size_t best = 0;
+      float bestCost = HUGE_VALF;
+    };
+
+    QuickPIDPlant::Model model;
+    float gain, t1, t2, deadTimeSec, sampleTimeSec, setpoint;
+    uint32_t samples;
+    QuickPID::Action action;
+    float outMin = 0, outMax = 255;
+    float wIae = 1, wItae = 0, wOvershoot = 0, wSettling = 0;
+    float band = 0.02f;
+
+    static float Lin(float Min, float Max, uint16_t i, uint16_t N) {
+      return (N > 1) ? Min + (Max - Min) * i / (N - 1) : Min;
+    }
+
+    uint16_t DeadTimeSamples() const {
+      float n = deadTimeSec / sampleTimeSec + 0.5f;
+      return (n < 65535.0f) ? (uint16_t)n + 1 : 65535;
+    }
+
+    // Runs this thread's share, then steals from the others until no work is left.
+    void Work(const QuickPIDCandidate *Candidates, QuickPIDMetrics *Metrics,
+              std::vector<Worker> *Workers, unsigned w) const {
+      std::vector<Worker> &wk = *Workers;
+      Worker &me = wk[w];
+      std::vector<float> buffer(DeadTimeSamples());
+      for (;;) {
+        size_t i;
+        bool have;
+        {
+          std::lock_guard<std::mutex> guard(me.lock);
+          i = me.next;
+          have = (i < me.end);
+          if (have) me.next++;
+        }
+        if (!have) {
+          if (!Steal(wk, w)) return;
+          continue;
+        }
+        QuickPIDMetrics m = Evaluate(Candidates[i], buffer.data());
+        if (Metrics != NULL) Metrics[i] = m;
+        if (m.cost < me.bestCost || (m.cost == me.bestCost && i < me.best)) {
+          me.best = i;
+          me.bestCost = m.cost;
+        }
+      }
+    }
+
+    // Moves the second half of another thread's remaining work to thread w. Returns false when none is left.
+    bool Steal(std::vector<Worker> &wk, unsigned w) const {
+      for (unsigned k = 1; k < wk.size(); k++) {
+        Worker &victim = wk[(w + k) % wk.size()];
+        size_t begin, end;
+        {
+          std::lock_guard<std::mutex> guard(victim.lock);
+          if (victim.next >= victim.end) continue;
+          end = victim.end;
+          begin = victim.next + (victim.end - victim.next) / 2;
+          victim.end = begin;
+        }
+        std::lock_guard<std::mutex> guard(wk[w].lock);
+        wk[w].next = begin;
+        wk[w].end = end;
+        return true;
+      }
+      return false;
+    }
+
+    QuickPIDMetrics Evaluate(const QuickPIDCandidate &c, float *buffer) const {
+      float input = 0, output = 0, sp = 0;
+      QuickPID pid(&input, &output, &sp, c.kp, c.ki, c.kd, c.pmode, c.dmode, c.iawmode, action, NULL);
+      pid.SetOutputLimits(outMin, outMax);
+      pid.SetSampleTimeUs((uint32_t)(sampleTimeSec * 1000000 + 0.5f));
+      pid.SetMode(QuickPID::Control::timer);
+      QuickPIDPlant plant(buffer, DeadTimeSamples());
+      plant.SetModel(model, gain, t1, t2, deadTimeSec, sampleTimeSec);
+
+      QuickPIDMetrics m = {0, 0, 0, 0, 0};
+      float sign = (setpoint < 0) ? -1.0f : 1.0f;
+      float settleBand = band * fabsf(setpoint);
+      float peak = 0;
+      sp = setpoint;
+      for (uint32_t k = 1; k <= samples; k++) {
+        pid.Compute();
+        input = plant.Step(output);
+        float t = k * sampleTimeSec;
+        float e = fabsf(sp - input);
+        m.iae += e * sampleTimeSec;
+        m.itae += t * e * sampleTimeSec;
+        float over = (input - sp) * sign;
+        if (over > peak) peak = over;
+        if (e > settleBand) m.settlingTime = t;
+      }
+      m.overshoot = (setpoint != 0) ? 100.0f * peak / fabsf(setpoint) : 0;
+      m.cost = wIae * m.iae + wItae * m.itae + wOvershoot * m.overshoot + wSettling * m.settlingTime;
+      if (!(m.cost == m.cost)) m.cost = HUGE_VALF;  // NaN from an unstable candidate
+      return m;
+    }
+
+}; // class QuickPIDSweep
+#endif // QuickPIDSweep.h
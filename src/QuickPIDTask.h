@@ -0,0 +1,201 @@
+#pragma once
+#ifndef QuickPIDTask_h
+#define QuickPIDTask_h
+
+#include "QuickPID.h"
+#include "QuickPIDMailbox.h"
+
+// Setpoint and tunings sent to a controller run by QuickPIDTask.
+struct QuickPIDCommand {
+  float setpoint, kp, ki, kd;
+};
+
+// Latest values of a controller run by QuickPIDTask.
+struct QuickPIDStatus {
+  uint32_t tick;               // Tick() count of the calculation
+  float input, setpoint, output;
+  float pTerm, iTerm, dTerm;
+};
+
+// User hooks called by Tick() around the calculations, in the control context.
+typedef void (*tQuickPIDTaskHook)(void *Arg);
+
+/**********************************************************************************
+   QuickPIDTask runs N QuickPID controllers at a fixed period in their own
+   control context, for example a high priority FreeRTOS task pinned to the
+   second core of an ESP32 or RP2040, away from the WiFi and network stack.
+
+   The application context changes setpoints and tunings with SetSetpoint()
+   and SetTunings(), and reads each controller's latest values with
+   GetStatus(). Both go through lock-free QuickPIDMailbox values, so neither
+   side ever waits for the other. A new command is applied at the start of
+   the next Tick().
+
+   Each Tick() calls the Before hook (read the sensors into input[]), applies
+   new commands, computes every controller with its value-passing Compute()
+   and publishes its status, then calls the After hook (write output[] to the
+   actuators). The controllers' sample times are set to the period, and they
+   must be in automatic or timer mode. Only the control context touches them
+   after Start().
+
+   With FreeRTOS (FreeRTOS.h included before this header, as Arduino.h does on
+   ESP32), Start() creates the task. A period of a whole number of ticks runs
+   it with vTaskDelayUntil(). Any other period (shorter than a tick, or 1500
+   µs with a 1 ms tick) makes the task wait for NotifyFromISR() from a
+   hardware timer interrupt at the period instead, so the calculations keep
+   the sample time the gains are scaled for. Without FreeRTOS, call Tick()
+   from a timer interrupt or a loop at the period.
+
+   QuickPID *loops[2] = {&pidA, &pidB};
+   QuickPIDTask<2> control(loops, 1000, readSensors, writeActuators);  // 1 ms
+   control.Start(1, 10);           // core 1, priority 10
+   control.SetSetpoint(0, 100);    // application core
+ **********************************************************************************/
+template <uint8_t N>
+class QuickPIDTask {
+
+  public:
+
+    float input[N];      // controller inputs, written by the Before hook
+    float output[N];     // controller outputs, read by the After hook
+
+    // Links the controllers and hooks and sets the controllers' sample times to PeriodUs.
+    // Setpoints start at 0, the tunings at the controllers' own.
+    QuickPIDTask(QuickPID *const Pids[N], uint32_t PeriodUs, tQuickPIDTaskHook Before = NULL,
+                 tQuickPIDTaskHook After = NULL, void *Arg = NULL) {
+      periodUs = (PeriodUs > 0) ? PeriodUs : 1;
+      before = Before;
+      after = After;
+      arg = Arg;
+      for (uint8_t i = 0; i < N; i++) {
+        pid[i] = Pids[i];
+        pid[i]->SetSampleTimeUs(periodUs);
+        sent[i].setpoint = 0;
+        sent[i].kp = pid[i]->GetKp();
+        sent[i].ki = pid[i]->GetKi();
+        sent[i].kd = pid[i]->GetKd();
+        setpoint[i] = 0;
+        input[i] = 0;
+        output[i] = 0;
+        command[i].Write(sent[i]);
+      }
+    }
+
+    // Sends a new setpoint to controller i. Application context only.
+    void SetSetpoint(uint8_t i, float Setpoint) {
+      sent[i].setpoint = Setpoint;
+      command[i].Write(sent[i]);
+    }
+
+    // Sends new tunings to controller i. Application context only.
+    void SetTunings(uint8_t i, float Kp, float Ki, float Kd) {
+      if (Kp < 0 || Ki < 0 || Kd < 0) return;
+      sent[i].kp = Kp;
+      sent[i].ki = Ki;
+      sent[i].kd = Kd;
+      command[i].Write(sent[i]);
+    }
+
+    // Copies the latest status of controller i. Application context only. Returns true if it's new.
+    bool GetStatus(uint8_t i, QuickPIDStatus &Status) {
+      return status[i].Read(Status);
+    }
+
+    // Runs one period: Before hook, commands, calculations, status, After hook. Control context only.
+    void Tick() {
+      if (before != NULL) before(arg);
+      for (uint8_t i = 0; i < N; i++) {
+        QuickPID &p = *pid[i];
+        QuickPIDCommand c;
+        if (command[i].Read(c)) {
+          setpoint[i] = c.setpoint;
+          if (c.kp != p.GetKp() || c.ki != p.GetKi() || c.kd != p.GetKd()) p.SetTunings(c.kp, c.ki, c.kd);
+        }
+        output[i] = p.Compute(input[i], setpoint[i]);
+        QuickPIDStatus s;
+        s.tick = ticks;
+        s.input = input[i];
+        s.setpoint = setpoint[i];
+        s.output = output[i];
+        s.pTerm = p.GetPterm();
+        s.iTerm = p.GetIterm();
+        s.dTerm = p.GetDterm();
+        status[i].Write(s);
+      }
+      if (after != NULL) after(arg);
+      ticks++;
+    }
+
+    // Returns the number of Tick() calls.
+    uint32_t GetTicks() { return ticks; }
+
+    // Returns the number of periods the task started late, for example after the previous Tick() overran
+    // (FreeRTOS only).
+    uint32_t GetOverruns() { return overruns; }
+
+#if defined(INC_FREERTOS_H)
+    // Creates the control task on Core (where the port supports pinning) with Priority. Returns false if
+    // the task couldn't be created.
+    bool Start(uint8_t Core, UBaseType_t Priority, uint32_t StackBytes = 4096) {
+      if (task != NULL) return false;
+#if defined(ESP_PLATFORM)
+      if (xTaskCreatePinnedToCore(Run, "QuickPID", StackBytes, this, Priority, &task, Core) != pdPASS) return false;
+#else
+      if (xTaskCreate(Run, "QuickPID", StackBytes / sizeof(StackType_t), this, Priority, &task) != pdPASS) return false;
+#if (configUSE_CORE_AFFINITY == 1) && ((configNUMBER_OF_CORES > 1) || (configNUM_CORES > 1))
+      vTaskCoreAffinitySet(task, (UBaseType_t)1 << Core);
+#else
+      (void)Core;
+#endif
+#endif
+      return true;
+    }
+
+    // Wakes the task for one Tick() when the period isn't a whole number of FreeRTOS ticks. Call from a
+    // hardware timer interrupt at the period.
+    void NotifyFromISR() {
+      if (task == NULL) return;
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveFromISR(task, &woken);
+      portYIELD_FROM_ISR(woken);
+    }
+#endif
+
+  private:
+
+#if defined(INC_FREERTOS_H)
+    static void Run(void *Self) {
+      QuickPIDTask &t = *(QuickPIDTask *)Self;
+      uint64_t scaled = (uint64_t)t.periodUs * configTICK_RATE_HZ;
+      // vTaskDelayUntil() only for whole ticks, a rounded period wouldn't match the sample time
+      TickType_t period = (scaled % 1000000 == 0) ? (TickType_t)(scaled / 1000000) : 0;
+      TickType_t last = xTaskGetTickCount();
+      for (;;) {
+        if (period > 0) {
+          vTaskDelayUntil(&last, period);
+          // vTaskDelayUntil() returns at once, after the wake time, when the last Tick() overran
+          if (xTaskGetTickCount() != last) t.overruns++;
+        } else {
+          // more than one pending notification means a period was missed
+          if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY) > 1) t.overruns++;
+        }
+        t.Tick();
+      }
+    }
+
+    TaskHandle_t task = NULL;
+#endif
+
+    QuickPID *pid[N];
+    QuickPIDCommand sent[N];                  // last commands sent, application side
+    QuickPIDMailbox<QuickPIDCommand> command[N];
+    QuickPIDMailbox<QuickPIDStatus> status[N];
+    float setpoint[N];                        // applied setpoints, control side
+    uint32_t periodUs;
+    tQuickPIDTaskHook before, after;
+    void *arg;
+    volatile uint32_t ticks = 0;
+    volatile uint32_t overruns = 0;
+
+}; // class QuickPIDTask
+#endif // QuickPIDTask.h
@@ -0,0 +1,69 @@
+/**********************************************************************************
+   QuickPIDTrace - lock-free telemetry ring buffer for QuickPID
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDTrace.h"
+
+/* Constructor ********************************************************************
+   The indices run freely and wrap at the width of index_t, so the number of
+   samples held is always head - tail. That needs a power of two size no
+   larger than half the index range.
+ **********************************************************************************/
+QuickPIDTrace::QuickPIDTrace(QuickPIDSample *Buffer, index_t Size) {
+  buffer = (Size > 0) ? Buffer : NULL;
+  index_t size = 1;
+  index_t maxSize = (index_t)(((index_t)~0 >> 1) + 1);
+  while (size < maxSize && (index_t)(size << 1) <= Size) size <<= 1;
+  mask = size - 1;
+}
+
+/* Push(.)*************************************************************************
+   The sample is written before the new head is published. The barrier keeps
+   the compiler (and the CPU, on multicore parts) from reordering the two.
+ **********************************************************************************/
+bool QuickPIDTrace::Push(const QuickPIDSample &Sample) {
+  index_t h = head;
+  pushed++;
+  if (buffer == NULL || (index_t)(h - tail) > mask) {
+    dropped = dropped + 1;
+    return false;
+  }
+  buffer[h & mask] = Sample;
+  __sync_synchronize();
+  head = h + 1;
+  return true;
+}
+
+bool QuickPIDTrace::Pop(QuickPIDSample &Sample) {
+  return Read(&Sample, 1) == 1;
+}
+
+/* Read(..)************************************************************************
+   The samples are copied out before the new tail is published, so the
+   producer can't overwrite them while they are being read.
+ **********************************************************************************/
+QuickPIDTrace::index_t QuickPIDTrace::Read(QuickPIDSample *Dest, index_t Max) {
+  index_t t = tail;
+  index_t n = head - t;
+  __sync_synchronize();
+  if (n > Max) n = Max;
+  for (index_t i = 0; i < n; i++) Dest[i] = buffer[(index_t)(t + i) & mask];
+  __sync_synchronize();
+  tail = t + n;
+  return n;
+}
+
+QuickPIDTrace::index_t QuickPIDTrace::Available() {
+  return head - tail;
+}
+
+/* GetDropped() ********************************************************************
+   The count is wider than the AVR can read in one instruction, so it's read
+   until two reads agree, in case the producer interrupted the first one.
+ **********************************************************************************/
+uint32_t QuickPIDTrace::GetDropped() {
+  uint32_t d;
+  do d = dropped; while (d != dropped);
+  return d;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef QuickPIDTrace_h
+#define QuickPIDTrace_h
+
+#include "QuickPIDClock.h"
+
+// One traced PID calculation.
+struct QuickPIDSample {
+  uint32_t time;               // Compute() clock ticks or Compute(nowUs) time, else the trace's push count
+  float input, setpoint;
+  float pTerm, iTerm, dTerm;
+  float output;
+};
+
+/**********************************************************************************
+   QuickPIDTrace is a single producer, single consumer ring buffer of
+   QuickPIDSample. A controller linked with QuickPID::SetTrace() pushes one
+   sample per calculation, from loop() or an interrupt, and loop() or a
+   background task drains it in batches with Read() and sends them on. Push()
+   never blocks or allocates: when the buffer is full the sample is dropped
+   and counted. Only the producer writes the head index and only the
+   consumer writes the tail, so no lock is needed.
+
+   The buffer memory is supplied by the user. Its size must be a power of
+   two, at most 128 on AVR (where the indices are single bytes so that they
+   are read and written atomically) and 32768 elsewhere.
+
+   QuickPIDSample traceBuffer[64];
+   QuickPIDTrace trace(traceBuffer, 64);
+   myPID.SetExtension(&pidExtension);  // the trace link is held in the extension
+   myPID.SetTrace(&trace);
+ **********************************************************************************/
+class QuickPIDTrace {
+
+  public:
+
+#if defined(__AVR__)
+    typedef uint8_t index_t;
+#else
+    typedef uint16_t index_t;
+#endif
+
+    // Constructor. Size must be a power of two, otherwise the largest power of two below it is used.
+    QuickPIDTrace(QuickPIDSample *Buffer, index_t Size);
+
+    // Adds a sample. Producer only. Returns false if the buffer is full and the sample was dropped.
+    bool Push(const QuickPIDSample &Sample);
+
+    // Removes the oldest sample. Consumer only. Returns false if the buffer is empty.
+    bool Pop(QuickPIDSample &Sample);
+
+    // Removes up to Max of the oldest samples into Dest. Consumer only. Returns the number read.
+    index_t Read(QuickPIDSample *Dest, index_t Max);
+
+    // Returns the number of samples waiting to be read.
+    index_t Available();
+
+    // Returns the number of samples dropped because the buffer was full.
+    uint32_t GetDropped();
+
+    // Returns the number of Push() calls, stored or dropped. Producer only.
+    uint32_t GetPushed() { return pushed; }
+
+  private:
+
+    QuickPIDSample *buffer;
+    index_t mask;                // size - 1
+    volatile index_t head = 0;   // free running, written by the producer
+    volatile index_t tail = 0;   // free running, written by the consumer
+    volatile uint32_t dropped = 0;
+    uint32_t pushed = 0;         // written and read by the producer only
+
+}; // class QuickPIDTrace
+#endif // QuickPIDTrace.h
@@ -0,0 +1,234 @@
+/**********************************************************************************
+   QuickPIDTraceFormat - compact binary trace frames for QuickPID
+   Licensed under the MIT License.
+ **********************************************************************************/
+
+#include "QuickPIDTraceFormat.h"
+#include <string.h>
+
+// A samples frame holds the count byte, then samples of at least one byte per field.
+static_assert(1 + QUICKPID_TRACE_SAMPLES_MAX * 7 <= QUICKPID_TRACE_PAYLOAD_MAX,
+              "QUICKPID_TRACE_SAMPLES_MAX samples must fit one payload");
+
+/* Byte helpers *******************************************************************/
+static uint8_t Crc8(uint8_t crc, uint8_t b) {
+  crc ^= b;
+  for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  return crc;
+}
+
+static uint8_t PutVarint(uint8_t *p, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool GetVarint(const uint8_t *p, uint8_t end, uint8_t &pos, uint32_t &v) {
+  v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (pos >= end) return false;
+    uint8_t b = p[pos++];
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static uint8_t PutFloat(uint8_t *p, float f) {
+  uint32_t u;
+  memcpy(&u, &f, 4);
+  for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(u >> (8 * i));
+  return 4;
+}
+
+static float GetFloat(const uint8_t *p) {
+  uint32_t u = 0;
+  for (uint8_t i = 0; i < 4; i++) u |= (uint32_t)p[i] << (8 * i);
+  float f;
+  memcpy(&f, &u, 4);
+  return f;
+}
+
+static uint32_t Zigzag(uint32_t v) {
+  return (v << 1) ^ (uint32_t)-(int32_t)(v >> 31);
+}
+
+static uint32_t Unzigzag(uint32_t v) {
+  return (v >> 1) ^ (uint32_t)-(int32_t)(v & 1);
+}
+
+// Frames the payload already written at Buffer + 3.
+static uint16_t Seal(uint8_t *Buffer, uint8_t type, uint8_t length) {
+  Buffer[0] = QUICKPID_TRACE_SYNC;
+  Buffer[1] = type;
+  Buffer[2] = length;
+  uint8_t crc = 0;
+  for (uint16_t i = 1; i < (uint16_t)length + 3; i++) crc = Crc8(crc, Buffer[i]);
+  Buffer[length + 3] = crc;
+  return (uint16_t)length + 4;
+}
+
+/* Encoder ************************************************************************/
+QuickPIDTraceEncoder::QuickPIDTraceEncoder(float Scale) {
+  scale = (Scale > 0) ? Scale : 100;
+}
+
+uint16_t QuickPIDTraceEncoder::Header(uint8_t *Buffer, QuickPID &Pid) {
+  uint8_t *p = Buffer + 3;
+  uint8_t n = 0;
+  p[n++] = QUICKPID_TRACE_VERSION;
+  n += PutFloat(p + n, Pid.GetKp());
+  n += PutFloat(p + n, Pid.GetKi());
+  n += PutFloat(p + n, Pid.GetKd());
+  p[n++] = Pid.GetMode();
+  p[n++] = Pid.GetDirection();
+  p[n++] = Pid.GetPmode();
+  p[n++] = Pid.GetDmode();
+  p[n++] = Pid.GetAwMode();
+  n += PutFloat(p + n, scale);
+  return Seal(Buffer, (uint8_t)Frame::header, n);
+}
+
+/* Samples(....)*******************************************************************
+   Each sample is encoded into a scratch buffer first, and copied into the
+   frame only if it fits. Differences are taken on the quantized values with
+   unsigned wrap, so the decoder recovers them exactly.
+ **********************************************************************************/
+uint16_t QuickPIDTraceEncoder::Samples(uint8_t *Buffer, const QuickPIDSample *Samples, uint8_t Count,
+                                       uint8_t &Used) {
+  uint8_t *p = Buffer + 3;
+  uint8_t n = 1;
+  uint32_t prev[7] = {0, 0, 0, 0, 0, 0, 0};
+  Used = 0;
+  while (Used < Count && Used < QUICKPID_TRACE_SAMPLES_MAX) {
+    const QuickPIDSample &s = Samples[Used];
+    const float v[6] = {s.input, s.setpoint, s.pTerm, s.iTerm, s.dTerm, s.output};
+    uint32_t q[7];
+    q[0] = s.time;
+    for (uint8_t i = 0; i < 6; i++) {
+      float x = v[i] * scale;
+      x = (x > 2147483520.0f) ? 2147483520.0f : (x < -2147483520.0f) ? -2147483520.0f : x;
+      q[i + 1] = (uint32_t)(int32_t)((x < 0) ? x - 0.5f : x + 0.5f);
+    }
+    uint8_t scratch[35];
+    uint8_t k = PutVarint(scratch, q[0] - prev[0]);
+    for (uint8_t i = 1; i < 7; i++) k += PutVarint(scratch + k, Zigzag(q[i] - prev[i]));
+    if ((uint16_t)n + k > QUICKPID_TRACE_PAYLOAD_MAX) break;
+    memcpy(p + n, scratch, k);
+    n += k;
+    memcpy(prev, q, sizeof(prev));
+    Used++;
+  }
+  p[0] = Used;
+  return Seal(Buffer, (uint8_t)Frame::samples, n);
+}
+
+/* Decoder ************************************************************************
+   A byte that doesn't complete a valid frame is discarded and the decoder
+   waits for the next sync byte, so it resynchronizes after lost bytes.
+ **********************************************************************************/
+QuickPIDTraceDecoder::Frame QuickPIDTraceDecoder::Put(uint8_t b) {
+  switch (state) {
+    case 0:
+      if (b == QUICKPID_TRACE_SYNC) state = 1;
+      break;
+    case 1:
+      type = b;
+      crc = Crc8(0, b);
+      state = 2;
+      break;
+    case 2:
+      length = b;
+      crc = Crc8(crc, b);
+      pos = 0;
+      state = (length > QUICKPID_TRACE_PAYLOAD_MAX) ? 0 : (length > 0) ? 3 : 4;
+      if (state == 0) errors++;
+      break;
+    case 3:
+      payload[pos++] = b;
+      crc = Crc8(crc, b);
+      if (pos >= length) state = 4;
+      break;
+    default:
+      state = 0;
+      if (b != crc) {
+        errors++;
+        break;
+      }
+      if (type == (uint8_t)Frame::header && DecodeHeader()) return Frame::header;
+      if (type == (uint8_t)Frame::samples && DecodeSamples()) return Frame::samples;
+      errors++;
+      break;
+  }
+  return Frame::none;
+}
+
+bool QuickPIDTraceDecoder::DecodeHeader() {
+  if (length < 22 || payload[0] != QUICKPID_TRACE_VERSION) return false;
+  header.kp = GetFloat(payload + 1);
+  header.ki = GetFloat(payload + 5);
+  header.kd = GetFloat(payload + 9);
+  header.mode = payload[13];
+  header.direction = payload[14];
+  header.pmode = payload[15];
+  header.dmode = payload[16];
+  header.awmode = payload[17];
+  float scale = GetFloat(payload + 18);
+  if (!(scale > 0)) return false;
+  header.scale = scale;
+  return true;
+}
+
+/* DecodeSamples() ****************************************************************
+   The whole payload is checked before any sample is written, so a malformed
+   frame that passes the CRC leaves the samples of the last good frame intact.
+   Checking in a first pass needs no second sample buffer on the stack.
+ **********************************************************************************/
+bool QuickPIDTraceDecoder::DecodeSamples() {
+  if (length < 1 || payload[0] > QUICKPID_TRACE_SAMPLES_MAX) return false;
+  uint8_t n = payload[0];
+  uint8_t p = 1;
+  uint32_t d;
+  for (uint16_t k = 0; k < 7 * n; k++) {
+    if (!GetVarint(payload, length, p, d)) return false;
+  }
+  if (p != length) return false;
+  p = 1;
+  uint32_t q[7] = {0, 0, 0, 0, 0, 0, 0};
+  float inv = 1.0f / header.scale;
+  for (uint8_t j = 0; j < n; j++) {
+    GetVarint(payload, length, p, d);
+    q[0] += d;
+    for (uint8_t i = 1; i < 7; i++) {
+      GetVarint(payload, length, p, d);
+      q[i] += Unzigzag(d);
+    }
+    QuickPIDSample &s = samples[j];
+    s.time = q[0];
+    s.input = (float)(int32_t)q[1] * inv;
+    s.setpoint = (float)(int32_t)q[2] * inv;
+    s.pTerm = (float)(int32_t)q[3] * inv;
+    s.iTerm = (float)(int32_t)q[4] * inv;
+    s.dTerm = (float)(int32_t)q[5] * inv;
+    s.output = (float)(int32_t)q[6] * inv;
+  }
+  count = n;
+  return true;
+}
+
+const QuickPIDTraceHeader &QuickPIDTraceDecoder::GetHeader() {
+  return header;
+}
+uint8_t QuickPIDTraceDecoder::GetCount() {
+  return count;
+}
+const QuickPIDSample *QuickPIDTraceDecoder::GetSamples() {
+  return samples;
+}
+uint32_t QuickPIDTraceDecoder::GetErrors() {
+  return errors;
+}
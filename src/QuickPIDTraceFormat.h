@@ -0,0 +1,99 @@
+#pragma once
+#ifndef QuickPIDTraceFormat_h
+#define QuickPIDTraceFormat_h
+
+#include "QuickPID.h"
+#include "QuickPIDTrace.h"
+
+/**********************************************************************************
+   Binary frame format for QuickPID traces, for links where bandwidth is the
+   limit (RS-485, radio). Every frame is
+
+     0xA5  type  length  payload[length]  crc
+
+   where crc is a CRC-8 (polynomial 0x07) of type, length and payload.
+   Multi-byte numbers are little endian.
+
+   Header frame (type 1): version (1), Kp, Ki, Kd (float), mode, direction,
+   pmode, dmode, awmode (byte each, as from the Get functions), and the
+   quantization scale in counts per unit (float).
+
+   Samples frame (type 2): sample count (1), then the first sample in full
+   and every following one as differences from the previous sample. The time
+   is an unsigned varint (7 bits per byte, low bits first). The input,
+   setpoint, P, I, D terms and output are quantized to round(value * scale)
+   and sent as zigzag varints. Each frame starts from a full sample, so a lost
+   frame doesn't corrupt the following ones. A slowly changing trace takes
+   about 7 to 12 bytes per sample instead of 28 raw, or 50 or more as text.
+ **********************************************************************************/
+
+#define QUICKPID_TRACE_SYNC 0xA5
+#define QUICKPID_TRACE_VERSION 1
+#define QUICKPID_TRACE_PAYLOAD_MAX 252
+#define QUICKPID_TRACE_FRAME_MAX (QUICKPID_TRACE_PAYLOAD_MAX + 4)
+#define QUICKPID_TRACE_SAMPLES_MAX ((QUICKPID_TRACE_PAYLOAD_MAX - 1) / 7)  // most that fit after the count, 7 bytes each
+
+// Controller settings sent in a header frame.
+struct QuickPIDTraceHeader {
+  float kp, ki, kd;
+  uint8_t mode, direction, pmode, dmode, awmode;
+  float scale;
+};
+
+class QuickPIDTraceEncoder {
+
+  public:
+
+    enum class Frame : uint8_t {none, header, samples};
+
+    // Constructor. Scale is the quantization in counts per unit (100 gives a resolution of 0.01).
+    QuickPIDTraceEncoder(float Scale = 100);
+
+    // Writes a header frame with the controller's tunings and modes into Buffer (at least
+    // QUICKPID_TRACE_FRAME_MAX bytes). Returns the frame length.
+    uint16_t Header(uint8_t *Buffer, QuickPID &Pid);
+
+    // Writes as many of Count samples as fit into one samples frame in Buffer. Returns the frame length and
+    // sets Used to the number of samples encoded.
+    uint16_t Samples(uint8_t *Buffer, const QuickPIDSample *Samples, uint8_t Count, uint8_t &Used);
+
+  private:
+
+    float scale;
+
+};
+
+class QuickPIDTraceDecoder {
+
+  public:
+
+    typedef QuickPIDTraceEncoder::Frame Frame;
+
+    // Feeds one received byte. Returns the type of a frame completed with a valid crc, otherwise none.
+    Frame Put(uint8_t b);
+
+    // The last header received.
+    const QuickPIDTraceHeader &GetHeader();
+
+    // The samples of the last samples frame, decoded with the scale of the last header.
+    uint8_t GetCount();
+    const QuickPIDSample *GetSamples();
+
+    // Returns the number of frames rejected for a bad crc or payload.
+    uint32_t GetErrors();
+
+  private:
+
+    bool DecodeHeader();
+    bool DecodeSamples();
+
+    uint8_t state = 0;          // 0 sync, 1 type, 2 length, 3 payload, 4 crc
+    uint8_t type = 0, length = 0, pos = 0, crc = 0;
+    uint8_t payload[QUICKPID_TRACE_PAYLOAD_MAX];
+    QuickPIDTraceHeader header = {0, 0, 0, 0, 0, 0, 0, 0, 100};
+    QuickPIDSample samples[QUICKPID_TRACE_SAMPLES_MAX];
+    uint8_t count = 0;
+    uint32_t errors = 0;
+
+};
+#endif // QuickPIDTraceFormat.h